@@ -0,0 +1,273 @@
+// Micro-benchmarks dos núcleos do solver (make bench).
+//
+// Uso: bench [filtro] [--min-time <s>]
+//
+// Cada benchmark roda até acumular --min-time segundos (padrão 0.2) no trecho
+// medido, sem contar a preparação, e escreve uma linha JSON:
+//
+//   {"benchmark":"parse","size":"formulas=1000,vars=16","runs":…,
+//    "ns_per_run":…,"items_per_run":…,"ns_per_item":…}
+//
+// As instâncias são geradas com semente fixa, iguais em toda execução.
+
+#include "solver.h"
+#include "parser.h"
+#include "formula.h"
+#include "linear_program.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Tempo acumulado só entre start e stop
+class Stopwatch {
+public:
+    void start() { begin = std::chrono::steady_clock::now(); }
+    void stop() { total += std::chrono::steady_clock::now() - begin; }
+    double seconds() const { return std::chrono::duration<double>(total).count(); }
+
+private:
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::duration total{0};
+};
+
+std::string filter;
+double minTime = 0.2;
+
+// Roda 'body' até --min-time no trecho medido; 'items' por execução
+template <class Body>
+void bench(const std::string& name, const std::string& size, double items, Body body) {
+    if (!filter.empty() && name.find(filter) == std::string::npos)
+        return;
+
+    // Preparação cara (ex.: resolver o PL antes da precificação) limita as
+    // execuções a 20×--min-time de relógio
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(20 * minTime);
+    Stopwatch sw;
+    long runs = 0;
+    do {
+        body(sw);
+        ++runs;
+    } while (sw.seconds() < minTime && std::chrono::steady_clock::now() < deadline);
+
+    double nsPerRun = sw.seconds() * 1e9 / runs;
+    std::cout << "{\"benchmark\":\"" << name << "\",\"size\":\"" << size << "\",\"runs\":" << runs
+              << ",\"ns_per_run\":" << nsPerRun << ",\"items_per_run\":" << items
+              << ",\"ns_per_item\":" << nsPerRun / items << "}" << std::endl;
+}
+
+// ----------- Instâncias sintéticas -----------
+
+std::string randomCPL(std::mt19937& rng, int vars, int depth) {
+    static const char* ops[] = {" ∧ ", " ∨ ", " → ", " ↔ "};
+    if (depth == 0 || rng() % 4 == 0) {
+        std::string v = "X" + std::to_string(rng() % vars + 1);
+        return rng() % 2 ? "¬" + v : v;
+    }
+    return "(" + randomCPL(rng, vars, depth - 1) + ops[rng() % 4] + randomCPL(rng, vars, depth - 1) + ")";
+}
+
+std::string randomModal(std::mt19937& rng, int vars, int depth) {
+    static const char* ops[] = {" ⊕ ", " ⊙ ", " ∧ ", " ∨ ", " → "};
+    if (depth == 0 || rng() % 3 == 0) {
+        std::string atom = "P(" + randomCPL(rng, vars, 3) + ")";
+        return rng() % 4 == 0 ? "¬" + atom : atom;
+    }
+    return "(" + randomModal(rng, vars, depth - 1) + ops[rng() % 5] + randomModal(rng, vars, depth - 1) + ")";
+}
+
+std::vector<std::string> randomInstance(int formulas, int vars, int depth, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> lines;
+    for (int k = 0; k < formulas; ++k)
+        lines.push_back(randomModal(rng, vars, depth));
+    return lines;
+}
+
+std::string sizeLabel(int formulas, int vars) {
+    return "formulas=" + std::to_string(formulas) + ",vars=" + std::to_string(vars);
+}
+
+} // namespace
+
+// Acesso aos núcleos privados do FPSolver
+struct SolverBench {
+    // Solver pré-processado com o PL raiz construído, como no início de search
+    struct Setup {
+        std::unique_ptr<FPSolver> solver;
+        std::unique_ptr<LinearProgram> rootLP;
+        std::vector<int> xVars;
+        std::vector<FormulaId> psiList;
+        std::vector<int> probConstraintRows;
+        int sumProbRow = 0;
+    };
+
+    static Setup prepare(const std::vector<std::string>& lines) {
+        FormulaStore store;
+        std::vector<FormulaId> roots;
+        for (const auto& line : lines)
+            roots.push_back(ModalParser(line, store).parse());
+
+        Setup s;
+        s.solver = std::make_unique<FPSolver>(std::move(store), std::move(roots), false);
+        s.solver->setPBOptions(false, "", "");
+        s.solver->preprocess();
+        s.solver->preprocessed = true;
+        s.rootLP = s.solver->buildRootLP(s.xVars, s.psiList, s.probConstraintRows, s.sumProbRow);
+        return s;
+    }
+
+    // Valorações pseudoaleatórias sobre as variáveis do solver
+    static std::vector<std::vector<bool>> valuations(const FPSolver& solver, int count, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::vector<std::vector<bool>> out(count, std::vector<bool>(solver.varList.size()));
+        for (auto& v : out)
+            for (size_t j = 0; j < v.size(); ++j)
+                v[j] = rng() & 1;
+        return out;
+    }
+
+    static void run() {
+        // Leitura: fórmulas de texto para um armazém novo
+        for (int formulas : {100, 1000}) {
+            auto lines = randomInstance(formulas, 16, 6, 1);
+            bench("parse", sizeLabel(formulas, 16), formulas, [&](Stopwatch& sw) {
+                FormulaStore store;
+                sw.start();
+                for (const auto& line : lines)
+                    ModalParser(line, store).parse();
+                sw.stop();
+            });
+        }
+
+        for (int formulas : {10, 30}) {
+            auto setup = prepare(randomInstance(formulas, 12, 5, 2));
+            FPSolver& solver = *setup.solver;
+            std::string size = sizeLabel(formulas, 12);
+
+            // Codificação dos gadgets Ł no PL
+            bench("encodeModalFormulas", size, formulas, [&](Stopwatch& sw) {
+                LinearProgram lp;
+                std::vector<int> xVars;
+                sw.start();
+                solver.encodeModalFormulas(lp, xVars);
+                sw.stop();
+            });
+
+            // Avaliação dos ψᵢ (CPL) num lote de valorações
+            auto batch = valuations(solver, 1024, 3);
+            bench("evaluatePsi", size, batch.size(), [&](Stopwatch& sw) {
+                sw.start();
+                for (const auto& v : batch)
+                    solver.evaluatePsi(setup.psiList, v);
+                sw.stop();
+            });
+
+            // Precificação exaustiva a partir do PL raiz com a coluna p(0)
+            auto priced = setup.rootLP->clone();
+            std::vector<bool> zero(solver.varList.size(), false);
+            solver.addValuationColumn(setup.psiList, *priced, setup.probConstraintRows, setup.sumProbRow, zero, "p(0)");
+            bench("pricing.exhaustive", size, 1, [&](Stopwatch& sw) {
+                auto lp = priced->clone();
+                lp->solve();
+                std::vector<double> duals = lp->getDuals();
+                std::set<std::vector<bool>> used{zero};
+                std::vector<FPSolver::Column> columns;
+                sw.start();
+                solver.addNewProbabilisticCoherenceConstraint(setup.psiList, *lp, duals,
+                                                              setup.probConstraintRows, setup.sumProbRow,
+                                                              used, columns, false);
+                sw.stop();
+            });
+
+            // Mesma precificação por padrões dos átomos P, com o oráculo (e
+            // sua memória) novo a cada execução
+            bench("pricing.patterns", size, 1, [&](Stopwatch& sw) {
+                auto lp = priced->clone();
+                lp->solve();
+                std::vector<double> duals = lp->getDuals();
+                std::set<std::vector<bool>> used{zero};
+                std::vector<FPSolver::Column> columns;
+                solver.patternPricing = true;
+                solver.patternOracle = std::make_unique<PatternOracle>(solver.store, solver.psiNodes, solver.psiSlot,
+                                                                       solver.propVarToId, solver.varList.size(),
+                                                                       setup.psiList);
+                sw.start();
+                solver.addNewProbabilisticCoherenceConstraint(setup.psiList, *lp, duals,
+                                                              setup.probConstraintRows, setup.sumProbRow,
+                                                              used, columns, false);
+                sw.stop();
+                solver.patternPricing = false;
+            });
+
+            // Problema de precificação em OPB, com 256 valorações já usadas
+            std::vector<mpz_class> coeffs;
+            std::mt19937 rng(4);
+            for (size_t i = 0; i <= setup.psiList.size(); ++i)
+                coeffs.push_back(mpz_class(static_cast<long>(rng() % 2000001) - 1000000));
+            auto usedList = valuations(solver, 256, 5);
+            std::set<std::vector<bool>> used(usedList.begin(), usedList.end());
+            std::string opb = (std::filesystem::temp_directory_path() / "fplsol_bench.opb").string();
+            bench("writeOPBFile", size, 1, [&](Stopwatch& sw) {
+                sw.start();
+                solver.writeOPBFile(setup.psiList, coeffs, used, opb);
+                sw.stop();
+            });
+            std::filesystem::remove(opb);
+
+            // Operações do LinearProgram sobre o PL raiz
+            size_t rows = setup.probConstraintRows.size();
+            bench("LinearProgram::clone", size, 1, [&](Stopwatch& sw) {
+                sw.start();
+                auto lp = setup.rootLP->clone();
+                sw.stop();
+            });
+
+            bench("LinearProgram::addColumn", size, 64, [&](Stopwatch& sw) {
+                auto lp = setup.rootLP->clone();
+                sw.start();
+                for (int c = 0; c < 64; ++c) {
+                    int idx = lp->addVariable("p(" + std::to_string(c) + ")", 0.0, 1.0);
+                    for (size_t i = c % 2; i < rows; i += 2)
+                        lp->addCoefficientToRow(setup.probConstraintRows[i], idx, 1.0);
+                    lp->addCoefficientToRow(setup.sumProbRow, idx, 1.0);
+                }
+                sw.stop();
+            });
+
+            bench("LinearProgram::solve", size, 1, [&](Stopwatch& sw) {
+                auto lp = priced->clone();
+                sw.start();
+                lp->solve();
+                sw.stop();
+            });
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--min-time" && i + 1 < argc) {
+            minTime = std::stod(argv[++i]);
+        } else if (arg == "--help") {
+            std::cout << "Use: bench [filter] [--min-time <s>]\n";
+            return 0;
+        } else {
+            filter = arg;
+        }
+    }
+
+    try {
+        SolverBench::run();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "batch.h"
+#include "parser.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Resultado de uma instância, uma linha da saída
+struct BatchRow {
+    std::string instance;
+    std::string verdict;    // SAT, UNSAT, TIMEOUT, UNKNOWN ou ERROR
+    std::string reason;     // motivo do veredito ou mensagem de erro
+    double seconds = 0.0;   // leitura + resolução
+    int nodes = 0;
+    int iterations = 0;
+    int columns = 0;
+};
+
+BatchRow solveInstance(const std::string& instance, const FPOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    BatchRow row;
+    row.instance = instance;
+
+    try {
+        // Uma thread por instância: a leitura não disputa núcleos com as outras
+        FormulaStore store;
+        std::vector<FormulaId> formulas = loadModalFormulasFromFile(instance, store, nullptr, 1);
+        FPResult result = fplSolve(std::move(store), std::move(formulas), options);
+
+        row.verdict = verdictName(result);
+        row.reason = result.reason;
+        row.nodes = result.nodes;
+        row.iterations = result.iterations;
+        row.columns = result.columns;
+    } catch (const std::exception& e) {
+        row.verdict = "ERROR";
+        row.reason = e.what();
+    }
+
+    row.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return row;
+}
+
+std::string csvField(const std::string& s) {
+    if (s.find_first_of(",\"\n\r") == std::string::npos)
+        return s;
+
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+void writeRow(std::ostream& out, const BatchRow& row, bool json) {
+    if (json) {
+        out << "{\"instance\":" << jsonString(row.instance)
+            << ",\"verdict\":" << jsonString(row.verdict)
+            << ",\"reason\":" << jsonString(row.reason)
+            << ",\"seconds\":" << row.seconds
+            << ",\"nodes\":" << row.nodes
+            << ",\"iterations\":" << row.iterations
+            << ",\"columns\":" << row.columns << "}\n";
+    } else {
+        out << csvField(row.instance) << "," << row.verdict << "," << csvField(row.reason) << ","
+            << row.seconds << "," << row.nodes << "," << row.iterations << "," << row.columns << "\n";
+    }
+}
+
+} // namespace
+
+std::string verdictName(const FPResult& result) {
+    switch (result.status) {
+        case FPStatus::SAT:   return "SAT";
+        case FPStatus::UNSAT: return "UNSAT";
+        default:              return result.reason == "time limit reached" ? "TIMEOUT" : "UNKNOWN";
+    }
+}
+
+std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+std::vector<std::string> listBatchInstances(const std::string& source) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> instances;
+
+    if (fs::is_directory(source)) {
+        for (const auto& entry : fs::directory_iterator(source)) {
+            std::string ext = entry.path().extension().string();
+            if (entry.is_regular_file() && (ext == ".fpl" || ext == ".txt" || ext == ".fplb"))
+                instances.push_back(entry.path().string());
+        }
+        std::sort(instances.begin(), instances.end());
+        return instances;
+    }
+
+    std::ifstream in(source);
+    if (!in)
+        throw std::runtime_error("Could not open file: " + source);
+
+    // Um caminho por linha; linhas vazias e comentários (#) são ignorados
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        size_t end = line.find_last_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#')
+            continue;
+        instances.push_back(line.substr(begin, end - begin + 1));
+    }
+    return instances;
+}
+
+void runBatch(const std::vector<std::string>& instances, const BatchOptions& options) {
+    bool json = options.format == "jsonl";
+    if (!json && options.format != "csv")
+        throw std::runtime_error("Unknown batch format: " + options.format);
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file)
+            throw std::runtime_error("Could not open file: " + options.output);
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+
+    if (!json)
+        out << "instance,verdict,reason,seconds,nodes,iterations,columns" << std::endl;
+
+    unsigned threads = options.threads;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, instances.size())));
+
+    // Cada thread pega a próxima instância livre; cada linha sai inteira,
+    // e já descarregada, assim que a instância termina
+    std::atomic<size_t> next{0};
+    std::mutex outMutex;
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (size_t k = next++; k < instances.size(); k = next++) {
+                BatchRow row = solveInstance(instances[k], options.solver);
+                std::lock_guard<std::mutex> lock(outMutex);
+                writeRow(out, row, json);
+                out.flush();
+            }
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+}
@@ -0,0 +1,30 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "fplsol.h"
+#include <string>
+#include <vector>
+
+// Modo --batch: muitas instâncias num único processo, em várias threads
+struct BatchOptions {
+    FPOptions solver;               // timeLimit vale por instância
+    unsigned threads = 0;           // 0: todos os núcleos
+    std::string format = "csv";     // csv ou jsonl
+    std::string output;             // arquivo de resultados (vazio: saída padrão)
+};
+
+// Instâncias de 'source': um diretório (arquivos .fpl, .txt e .fplb, em
+// ordem de nome) ou um arquivo com um caminho por linha
+std::vector<std::string> listBatchInstances(const std::string& source);
+
+// SAT, UNSAT, TIMEOUT (limite de tempo) ou UNKNOWN (cancelamento)
+std::string verdictName(const FPResult& result);
+
+// Texto como string JSON, com aspas e escapes (linhas JSONL de --batch e --serve)
+std::string jsonString(const std::string& s);
+
+// Resolve as instâncias e escreve uma linha por instância, na ordem em que
+// terminam. Erros de uma instância viram a linha ERROR, sem parar as demais.
+void runBatch(const std::vector<std::string>& instances, const BatchOptions& options);
+
+#endif // BATCH_HPP
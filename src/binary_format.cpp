@@ -0,0 +1,193 @@
+#include "binary_format.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr char MAGIC[4] = {'F', 'P', 'L', 'B'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint32_t ORDER_MARK = 0x01020304;
+
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t numVars;
+    std::uint32_t numNodes;
+    std::uint32_t numRoots;
+    std::uint32_t namesBytes;
+    std::uint32_t reserved;
+};
+
+struct VarEntry {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+struct Node {
+    std::uint32_t kind;     // modal | op << 8
+    std::int32_t left;
+    std::int32_t right;
+    std::int32_t var;
+};
+
+static_assert(sizeof(Header) == 32 && sizeof(VarEntry) == 8 && sizeof(Node) == 16,
+              "Layout do formato binário");
+
+[[noreturn]] void invalid(const std::string& reason) {
+    throw std::runtime_error("Invalid binary instance: " + reason);
+}
+
+template <typename T>
+std::vector<T> readArray(std::string_view data, size_t& offset, size_t count) {
+    std::vector<T> out(count);
+    if (count > 0)
+        std::memcpy(out.data(), data.data() + offset, count * sizeof(T));
+    offset += count * sizeof(T);
+    return out;
+}
+
+} // namespace
+
+bool isBinaryInstance(std::string_view data) {
+    return data.size() >= sizeof(MAGIC) && std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+std::vector<FormulaId> readBinaryInstance(std::string_view data, FormulaStore& store) {
+    // Num armazém já em uso, lê à parte e funde
+    if (store.size() > 0) {
+        FormulaStore local;
+        std::vector<FormulaId> roots = readBinaryInstance(data, local);
+        return store.merge(local, roots);
+    }
+
+    Header h;
+    if (data.size() < sizeof(Header))
+        invalid("truncated header");
+    std::memcpy(&h, data.data(), sizeof(Header));
+
+    if (!isBinaryInstance(data))
+        invalid("bad signature");
+    if (h.byteOrder != ORDER_MARK)
+        invalid("byte order mismatch");
+    if (h.version != VERSION)
+        invalid("unsupported version " + std::to_string(h.version));
+
+    std::uint64_t expected = sizeof(Header) + std::uint64_t(h.numVars) * sizeof(VarEntry) +
+                             std::uint64_t(h.numNodes) * sizeof(Node) +
+                             std::uint64_t(h.numRoots) * sizeof(std::int32_t) + h.namesBytes;
+    if (expected != data.size())
+        invalid("size mismatch");
+
+    size_t offset = sizeof(Header);
+    auto vars = readArray<VarEntry>(data, offset, h.numVars);
+    auto nodes = readArray<Node>(data, offset, h.numNodes);
+    auto roots = readArray<std::int32_t>(data, offset, h.numRoots);
+    std::string_view names = data.substr(offset, h.namesBytes);
+
+    for (const auto& v : vars) {
+        if (std::uint64_t(v.offset) + v.length > names.size())
+            invalid("variable name out of range");
+        store.varNames.emplace_back(names.substr(v.offset, v.length));
+    }
+
+    // Valida a estrutura do DAG enquanto copia os nós; os nós estruturais
+    // entram pelo intern, que refaz a tabela de hash-consing e acusa os
+    // repetidos
+    store.nodes.reserve(h.numNodes);
+    for (FormulaId id = 0; id < static_cast<FormulaId>(nodes.size()); ++id) {
+        const Node& n = nodes[id];
+        bool modal = (n.kind & 0xFF) != 0;
+        std::uint8_t op = static_cast<std::uint8_t>(n.kind >> 8);
+
+        auto child = [&](FormulaId c, bool childModal) {
+            if (c < 0 || c >= id)
+                invalid("child out of order at node " + std::to_string(id));
+            if (store.nodes[c].modal != childModal)
+                invalid("level mismatch at node " + std::to_string(id));
+        };
+
+        if (!modal && op == static_cast<std::uint8_t>(CPLConnective::VAR)) {
+            if (n.var < 0 || n.var >= static_cast<int>(h.numVars))
+                invalid("variable out of range at node " + std::to_string(id));
+            if (!store.varIndex.emplace(store.varNames[n.var], id).second)
+                invalid("duplicate variable node");
+            store.nodes.push_back({false, op, NO_FORMULA, NO_FORMULA, n.var});
+            continue;
+        }
+
+        bool unary;
+        if (modal) {
+            if (op > static_cast<std::uint8_t>(ModalConnective::ODOT))
+                invalid("unknown modal connective");
+            bool patom = op == static_cast<std::uint8_t>(ModalConnective::P_ATOM);
+            unary = patom || op == static_cast<std::uint8_t>(ModalConnective::NOT);
+            child(n.left, !patom);
+        } else {
+            if (op > static_cast<std::uint8_t>(CPLConnective::IFF))
+                invalid("unknown CPL connective");
+            unary = op == static_cast<std::uint8_t>(CPLConnective::NOT);
+            child(n.left, false);
+        }
+
+        if (unary) {
+            if (n.right != NO_FORMULA)
+                invalid("unexpected right child at node " + std::to_string(id));
+        } else {
+            child(n.right, modal);
+        }
+
+        if (store.intern({modal, op, n.left, n.right}) != id)
+            invalid("duplicate node " + std::to_string(id));
+    }
+
+    std::vector<FormulaId> formulas;
+    formulas.reserve(roots.size());
+    for (std::int32_t r : roots) {
+        if (r < 0 || r >= static_cast<FormulaId>(store.size()) || !store[r].modal)
+            invalid("bad formula root");
+        formulas.push_back(r);
+    }
+    return formulas;
+}
+
+void writeBinaryInstance(const std::string& filename, const FormulaStore& store,
+                         const std::vector<FormulaId>& roots) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Could not open file: " + filename);
+
+    std::vector<VarEntry> vars;
+    std::string names;
+    for (const auto& name : store.varNames) {
+        vars.push_back({static_cast<std::uint32_t>(names.size()), static_cast<std::uint32_t>(name.size())});
+        names += name;
+    }
+
+    std::vector<Node> nodes;
+    nodes.reserve(store.size());
+    for (const auto& n : store.nodes)
+        nodes.push_back({static_cast<std::uint32_t>(n.modal) | (static_cast<std::uint32_t>(n.op) << 8),
+                         n.left, n.right, n.var});
+
+    Header h;
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.byteOrder = ORDER_MARK;
+    h.numVars = static_cast<std::uint32_t>(vars.size());
+    h.numNodes = static_cast<std::uint32_t>(nodes.size());
+    h.numRoots = static_cast<std::uint32_t>(roots.size());
+    h.namesBytes = static_cast<std::uint32_t>(names.size());
+    h.reserved = 0;
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(vars.data()), vars.size() * sizeof(VarEntry));
+    out.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(Node));
+    out.write(reinterpret_cast<const char*>(roots.data()), roots.size() * sizeof(std::int32_t));
+    out.write(names.data(), names.size());
+
+    if (!out)
+        throw std::runtime_error("Failed writing binary instance: " + filename);
+}
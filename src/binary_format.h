@@ -0,0 +1,32 @@
+#ifndef BINARY_FORMAT_HPP
+#define BINARY_FORMAT_HPP
+
+#include "formula.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Formato binário de instâncias: o DAG do FormulaStore já com hash-consing
+// e variáveis internadas. Little-endian, tudo em campos de 32 bits:
+//
+//   cabeçalho  "FPLB", versão, marca de ordem de bytes, nº de variáveis,
+//              nº de nós, nº de fórmulas, tamanho dos nomes, reservado
+//   variáveis  (deslocamento, tamanho) de cada nome no bloco de nomes
+//   nós        (modal | op << 8, esquerda, direita, variável)
+//   fórmulas   IDs das raízes, na ordem do arquivo de texto
+//   nomes      bytes dos nomes, sem separadores
+//
+// Os filhos de cada nó têm ID menor, como no armazém; a leitura só valida e
+// copia os vetores, sem análise sintática.
+
+// true se 'data' começa com a assinatura do formato binário
+bool isBinaryInstance(std::string_view data);
+
+// Lê uma instância binária (já mapeada em memória) para o armazém
+std::vector<FormulaId> readBinaryInstance(std::string_view data, FormulaStore& store);
+
+// Grava as fórmulas 'roots' do armazém em formato binário
+void writeBinaryInstance(const std::string& filename, const FormulaStore& store,
+                         const std::vector<FormulaId>& roots);
+
+#endif // BINARY_FORMAT_HPP
@@ -0,0 +1,133 @@
+#include "checkpoint.h"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const char* const MAGIC = "FPLCHECKPOINT";
+constexpr int VERSION = 1;
+
+[[noreturn]] void invalid(const std::string& filename, const std::string& reason) {
+    throw std::runtime_error("Invalid checkpoint " + filename + ": " + reason);
+}
+
+// Próxima linha com a palavra-chave 'key'; o resto fica em 'fields'
+void expect(std::istream& in, const std::string& filename, const std::string& key, std::istringstream& fields) {
+    std::string line, word;
+    if (!std::getline(in, line))
+        invalid(filename, "missing '" + key + "'");
+    fields.clear();
+    fields.str(line);
+    if (!(fields >> word) || word != key)
+        invalid(filename, "expected '" + key + "'");
+}
+
+} // namespace
+
+void writeCheckpoint(const std::string& filename, const Checkpoint& cp) {
+    std::string temp = filename + ".tmp";
+    {
+        std::ofstream out(temp);
+        if (!out)
+            throw std::runtime_error("Could not open file: " + temp);
+
+        out << MAGIC << " " << VERSION << "\n";
+        out << "fingerprint " << std::hex << cp.fingerprint << std::dec << "\n";
+        out << "counters " << cp.nodes << " " << cp.iterations << " " << cp.columns << " "
+            << std::setprecision(17) << cp.seconds << "\n";
+
+        out << "valuations " << cp.valuations.size() << "\n";
+        for (const auto& v : cp.valuations) {
+            for (bool b : v)
+                out << (b ? '1' : '0');
+            out << "\n";
+        }
+
+        out << "branches " << cp.frontier.size() << "\n";
+        for (const auto& node : cp.frontier) {
+            out << node.fixedBinaries.size();
+            for (const auto& [b, val] : node.fixedBinaries)
+                out << " " << b << "=" << val;
+            out << " " << node.columns.size();
+            for (int c : node.columns)
+                out << " " << c;
+            out << "\n";
+        }
+
+        if (!out.flush())
+            throw std::runtime_error("Could not write file: " + temp);
+    }
+
+    if (std::rename(temp.c_str(), filename.c_str()) != 0)
+        throw std::runtime_error("Could not rename " + temp + " to " + filename);
+}
+
+Checkpoint readCheckpoint(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in)
+        throw std::runtime_error("Could not open file: " + filename);
+
+    Checkpoint cp;
+    std::istringstream fields;
+    int version = 0;
+    expect(in, filename, MAGIC, fields);
+    if (!(fields >> version) || version != VERSION)
+        invalid(filename, "unsupported version");
+
+    expect(in, filename, "fingerprint", fields);
+    if (!(fields >> std::hex >> cp.fingerprint >> std::dec))
+        invalid(filename, "bad fingerprint");
+
+    expect(in, filename, "counters", fields);
+    if (!(fields >> cp.nodes >> cp.iterations >> cp.columns >> cp.seconds))
+        invalid(filename, "bad counters");
+
+    size_t count = 0;
+    expect(in, filename, "valuations", fields);
+    if (!(fields >> count))
+        invalid(filename, "bad valuation count");
+    cp.valuations.resize(count);
+    for (auto& v : cp.valuations) {
+        std::string bits;
+        if (!std::getline(in, bits) || bits.find_first_not_of("01") != std::string::npos)
+            invalid(filename, "bad valuation");
+        for (char c : bits)
+            v.push_back(c == '1');
+    }
+
+    expect(in, filename, "branches", fields);
+    if (!(fields >> count))
+        invalid(filename, "bad branch count");
+    cp.frontier.resize(count);
+    for (auto& node : cp.frontier) {
+        std::string line;
+        if (!std::getline(in, line))
+            invalid(filename, "missing branch");
+        std::istringstream branch(line);
+
+        size_t numFixed = 0, numColumns = 0;
+        if (!(branch >> numFixed))
+            invalid(filename, "bad branch");
+        for (size_t k = 0; k < numFixed; ++k) {
+            std::string item;
+            size_t eq;
+            if (!(branch >> item) || (eq = item.rfind('=')) == std::string::npos ||
+                (item.substr(eq + 1) != "0" && item.substr(eq + 1) != "1"))
+                invalid(filename, "bad fixed binary");
+            node.fixedBinaries[item.substr(0, eq)] = item[eq + 1] - '0';
+        }
+
+        if (!(branch >> numColumns))
+            invalid(filename, "bad branch");
+        for (size_t k = 0; k < numColumns; ++k) {
+            int c;
+            if (!(branch >> c) || c < 0 || static_cast<size_t>(c) >= cp.valuations.size())
+                invalid(filename, "bad column index");
+            node.columns.push_back(c);
+        }
+    }
+    return cp;
+}
@@ -0,0 +1,45 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Estado de uma busca interrompida (--checkpoint, --resume): os ramos ainda
+// abertos, com as binárias fixadas e as colunas p(·) do último PL de cada
+// um, e os contadores. Arquivo de texto:
+//
+//   FPLCHECKPOINT 1
+//   fingerprint <hex>
+//   counters <nós> <iterações> <colunas> <segundos>
+//   valuations <quantidade>
+//   <valoração como bits 0/1>          (uma por linha)
+//   branches <quantidade>
+//   <k> <b(id)>=<0|1> ... <c> <índice da valoração> ...
+//
+// As valorações são compartilhadas entre os ramos e seguem a ordem das
+// variáveis do solver; 'fingerprint' identifica a instância e as opções.
+struct Checkpoint {
+    struct Node {
+        std::map<std::string, int> fixedBinaries;
+        std::vector<int> columns;       // índices em 'valuations'
+    };
+
+    std::uint64_t fingerprint = 0;
+    int nodes = 0;
+    int iterations = 0;
+    int columns = 0;
+    double seconds = 0.0;               // tempo somado das execuções anteriores
+    std::vector<std::vector<bool>> valuations;
+    std::vector<Node> frontier;
+};
+
+// Grava num arquivo temporário e o renomeia: o anterior só é trocado por
+// um arquivo completo
+void writeCheckpoint(const std::string& filename, const Checkpoint& checkpoint);
+
+// Lança std::runtime_error se o arquivo não existe ou é inválido
+Checkpoint readCheckpoint(const std::string& filename);
+
+#endif // CHECKPOINT_HPP
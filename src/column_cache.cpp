@@ -0,0 +1,125 @@
+#include "column_cache.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[4] = {'F', 'P', 'L', 'C'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint32_t ORDER_MARK = 0x01020304;
+
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t numVars;
+    std::uint32_t numValuations;
+    std::uint32_t keyLow;
+    std::uint32_t keyHigh;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(Header) == 32, "Layout do cache de colunas");
+
+[[noreturn]] void invalid(const std::string& filename, const std::string& reason) {
+    throw std::runtime_error("Invalid column cache " + filename + ": " + reason);
+}
+
+size_t wordsPerValuation(size_t numVars) {
+    return (numVars + 63) / 64;
+}
+
+} // namespace
+
+std::string columnCacheFile(const std::string& dir, std::uint64_t key) {
+    std::ostringstream name;
+    name << std::hex << key << ".fplc";
+    return (std::filesystem::path(dir) / name.str()).string();
+}
+
+std::vector<std::vector<bool>> readColumnCache(const std::string& filename, std::uint64_t key, size_t numVars) {
+    if (!std::filesystem::exists(filename))
+        return {};
+
+    MappedFile file(filename);
+    std::string_view data = file.text();
+
+    Header h;
+    if (data.size() < sizeof(Header))
+        invalid(filename, "truncated header");
+    std::memcpy(&h, data.data(), sizeof(Header));
+
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0)
+        invalid(filename, "bad signature");
+    if (h.byteOrder != ORDER_MARK)
+        invalid(filename, "byte order mismatch");
+    if (h.version != VERSION)
+        invalid(filename, "unsupported version " + std::to_string(h.version));
+    if ((std::uint64_t(h.keyHigh) << 32 | h.keyLow) != key || h.numVars != numVars)
+        invalid(filename, "written for another set of P atoms");
+
+    size_t words = wordsPerValuation(numVars);
+    if (data.size() != sizeof(Header) + std::uint64_t(h.numValuations) * words * sizeof(std::uint64_t))
+        invalid(filename, "size does not match header");
+
+    std::vector<std::vector<bool>> valuations(h.numValuations, std::vector<bool>(numVars));
+    const char* p = data.data() + sizeof(Header);
+    for (auto& v : valuations) {
+        for (size_t w = 0; w < words; ++w, p += sizeof(std::uint64_t)) {
+            std::uint64_t bits;
+            std::memcpy(&bits, p, sizeof(bits));
+            for (size_t j = w * 64; j < std::min(numVars, (w + 1) * 64); ++j)
+                v[j] = (bits >> (j % 64)) & 1;
+        }
+    }
+    return valuations;
+}
+
+void writeColumnCache(const std::string& filename, std::uint64_t key, size_t numVars,
+                      const std::vector<std::vector<bool>>& valuations) {
+    std::filesystem::path path(filename);
+    if (path.has_parent_path())
+        std::filesystem::create_directories(path.parent_path());
+
+    // Nome temporário único por processo e thread
+    std::ostringstream temp;
+    temp << filename << ".tmp." << ::getpid() << "." << std::hash<std::thread::id>{}(std::this_thread::get_id());
+    {
+        std::ofstream out(temp.str(), std::ios::binary);
+        if (!out)
+            throw std::runtime_error("Could not open file: " + temp.str());
+
+        Header h{};
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.byteOrder = ORDER_MARK;
+        h.numVars = static_cast<std::uint32_t>(numVars);
+        h.numValuations = static_cast<std::uint32_t>(valuations.size());
+        h.keyLow = static_cast<std::uint32_t>(key);
+        h.keyHigh = static_cast<std::uint32_t>(key >> 32);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+        std::vector<std::uint64_t> words(wordsPerValuation(numVars));
+        for (const auto& v : valuations) {
+            std::fill(words.begin(), words.end(), 0);
+            for (size_t j = 0; j < numVars && j < v.size(); ++j)
+                if (v[j]) words[j / 64] |= std::uint64_t(1) << (j % 64);
+            out.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(std::uint64_t));
+        }
+
+        if (!out.flush())
+            throw std::runtime_error("Could not write file: " + temp.str());
+    }
+
+    if (std::rename(temp.str().c_str(), filename.c_str()) != 0)
+        throw std::runtime_error("Could not rename " + temp.str() + " to " + filename);
+}
@@ -0,0 +1,31 @@
+#ifndef COLUMN_CACHE_HPP
+#define COLUMN_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cache de colunas entre execuções (--column-cache <dir>): valorações que
+// sustentaram os PLs de nó de execuções anteriores, um arquivo por chave,
+// <dir>/<chave>.fplc. A chave é um hash canônico dos ψᵢ e da ordem das
+// variáveis, da qual dependem as posições nas valorações. Little-endian:
+//
+//   cabeçalho   "FPLC", versão, marca de ordem de bytes, nº de variáveis,
+//               nº de valorações, chave (dois campos de 32 bits), reservado
+//   valorações  ceil(variáveis / 64) palavras de 64 bits cada, bit j na
+//               palavra j / 64
+//
+// O arquivo é lido mapeado em memória.
+
+std::string columnCacheFile(const std::string& dir, std::uint64_t key);
+
+// Valorações gravadas para 'key' (vazio se o arquivo não existe); lança
+// std::runtime_error se o arquivo é inválido ou de outra chave
+std::vector<std::vector<bool>> readColumnCache(const std::string& filename, std::uint64_t key, size_t numVars);
+
+// Grava num arquivo temporário e o renomeia, pois várias execuções podem
+// compartilhar o diretório
+void writeColumnCache(const std::string& filename, std::uint64_t key, size_t numVars,
+                      const std::vector<std::vector<bool>>& valuations);
+
+#endif // COLUMN_CACHE_HPP
@@ -0,0 +1,77 @@
+#include "cuts.h"
+
+// ----------- Facetas por gadget -----------
+
+void CutPool::clear() {
+    cuts.clear();
+}
+
+void CutPool::add(Cut cut) {
+    cuts.push_back(std::move(cut));
+}
+
+void CutPool::addGadgetCuts(ModalConnective op, int l, int r, int z) {
+    using M = ModalConnective;
+    const int LE = LinearProgram::LE;
+    const int GE = LinearProgram::GE;
+
+    switch (op) {
+        case M::OPLUS:
+            cuts.push_back({{{z, 1}, {l, -1}}, GE, 0});
+            cuts.push_back({{{z, 1}, {r, -1}}, GE, 0});
+            break;
+        case M::ODOT:
+            cuts.push_back({{{z, 1}, {l, -1}}, LE, 0});
+            cuts.push_back({{{z, 1}, {r, -1}}, LE, 0});
+            break;
+        case M::AND:
+            cuts.push_back({{{z, 1}, {l, -1}, {r, -1}}, GE, -1});
+            break;
+        case M::OR:
+            cuts.push_back({{{z, 1}, {l, -1}, {r, -1}}, LE, 0});
+            break;
+        case M::IMPLIES:
+            cuts.push_back({{{z, 1}, {l, 1}}, GE, 1});
+            cuts.push_back({{{z, 1}, {r, -1}}, GE, 0});
+            break;
+        case M::IFF:
+            cuts.push_back({{{z, 1}, {l, 1}, {r, 1}}, GE, 1});
+            cuts.push_back({{{z, 1}, {l, -1}, {r, -1}}, GE, -1});
+            break;
+        default:
+            // ¬ e Pφ já são exatos na relaxação
+            break;
+    }
+}
+
+// ----------- Aplicação no PL -----------
+
+int CutPool::addAll(LinearProgram& lp) const {
+    for (const auto& c : cuts)
+        lp.addConstraint(c.terms, c.sense, c.rhs);
+    return static_cast<int>(cuts.size());
+}
+
+int CutPool::separate(LinearProgram& lp, std::vector<bool>& added, double tolerance) const {
+    added.resize(cuts.size(), false);
+    std::vector<double> x = lp.getPrimal();
+
+    int count = 0;
+    for (size_t k = 0; k < cuts.size(); ++k) {
+        if (added[k]) continue;
+
+        const Cut& c = cuts[k];
+        double activity = 0.0;
+        for (const auto& [idx, coeff] : c.terms)
+            activity += coeff * x[idx];
+
+        bool violated = (c.sense == LinearProgram::GE && activity < c.rhs - tolerance) ||
+                        (c.sense == LinearProgram::LE && activity > c.rhs + tolerance);
+        if (violated) {
+            lp.addConstraint(c.terms, c.sense, c.rhs);
+            added[k] = true;
+            ++count;
+        }
+    }
+    return count;
+}
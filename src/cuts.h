@@ -0,0 +1,48 @@
+#ifndef CUTS_HPP
+#define CUTS_HPP
+
+#include "formula.h"
+#include "fplsol.h"
+#include "linear_program.h"
+#include <vector>
+#include <utility>
+
+// Desigualdade válida: ∑ coef·x  (sense)  rhs
+struct Cut {
+    std::vector<std::pair<int, double>> terms;
+    int sense;
+    double rhs;
+};
+
+// Conjunto de desigualdades válidas, adicionadas ao PL todas de uma vez ou
+// só as violadas pela solução corrente.
+//
+// addGadgetCuts gera as facetas da envoltória convexa dos gadgets Ł.
+// Para z = f(l, r) com f ∈ {⊕, ⊙, ∧, ∨, →, ↔}, a codificação com a variável
+// b só impõe, na relaxação, uma média das duas faces do gadget. As facetas
+// abaixo são as envoltórias côncava/convexa de f sobre [0,1]²:
+//   ⊕: z ≥ l, z ≥ r            ⊙: z ≤ l, z ≤ r
+//   ∧: z ≥ l + r - 1           ∨: z ≤ l + r
+//   →: z ≥ 1 - l, z ≥ r        ↔: z ≥ 1 - l - r, z ≥ l + r - 1
+// Só as facetas de cada gadget isolado são geradas; as da envoltória de uma
+// composição de gadgets (cadeias de ⊕, ∧ etc.) em geral não são somas destas.
+class CutPool {
+public:
+    void clear();
+    void add(Cut cut);
+    void addGadgetCuts(ModalConnective op, int leftX, int rightX, int xIdx);
+
+    // Adiciona todas ao PL
+    int addAll(LinearProgram& lp) const;
+
+    // Adiciona as desigualdades violadas pela solução corrente do PL;
+    // 'added' marca as que já estão no PL deste nó
+    int separate(LinearProgram& lp, std::vector<bool>& added, double tolerance = 1e-6) const;
+
+    size_t size() const { return cuts.size(); }
+
+private:
+    std::vector<Cut> cuts;
+};
+
+#endif // CUTS_HPP
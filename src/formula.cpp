@@ -1,174 +1,185 @@
 #include "formula.h"
+#include <algorithm>
+#include <stdexcept>
 
 // ------------------------
-// CPLFormula Implementação
+// FormulaStore Implementação
 // ------------------------
 
-CPLFormula::CPLFormula() = default;
-
-CPLFormula CPLFormula::variable(const std::string& name) {
-    CPLFormula f;
-    f.op = CPLConnective::VAR;
-    f.var = name;
-    return f;
-}
+FormulaId FormulaStore::intern(const Key& key) {
+    if (2 * (nodes.size() + 1) > table.size())
+        growTable();
+
+    size_t mask = table.size() - 1;
+    for (size_t i = hashKey(key.modal, key.op, key.left, key.right) & mask;; i = (i + 1) & mask) {
+        FormulaId id = table[i];
+        if (id == NO_FORMULA) {
+            id = static_cast<FormulaId>(nodes.size());
+            nodes.push_back({key.modal, key.op, key.left, key.right, -1});
+            table[i] = id;
+            return id;
+        }
 
-CPLFormula CPLFormula::unary(CPLConnective op, CPLFormula operand) {
-    CPLFormula f;
-    f.op = op;
-    f.left = std::make_unique<CPLFormula>(std::move(operand));
-    return f;
+        const FormulaNode& n = nodes[id];
+        if (n.modal == key.modal && n.op == key.op && n.left == key.left && n.right == key.right)
+            return id;
+    }
 }
 
-CPLFormula CPLFormula::binary(CPLConnective op, CPLFormula lhs, CPLFormula rhs) {
-    CPLFormula f;
-    f.op = op;
-    f.left = std::make_unique<CPLFormula>(std::move(lhs));
-    f.right = std::make_unique<CPLFormula>(std::move(rhs));
-    return f;
-}
+void FormulaStore::growTable() {
+    table.assign(std::max<size_t>(1024, 2 * table.size()), NO_FORMULA);
+    size_t mask = table.size() - 1;
 
-void CPLFormula::collectPropVars(std::unordered_map<std::string, int>& propVarToId) const {
-    using C = CPLConnective;
+    // As variáveis ficam em varIndex, fora da tabela
+    for (FormulaId id = 0; id < static_cast<FormulaId>(nodes.size()); ++id) {
+        const FormulaNode& n = nodes[id];
+        if (!n.modal && n.cplOp() == CPLConnective::VAR)
+            continue;
 
-    if (op == C::VAR) {
-        if (!propVarToId.count(var)) {
-            int id = static_cast<int>(propVarToId.size());
-            propVarToId[var] = id;
-        }
-    } else if (op == C::NOT) {
-        if (left) left->collectPropVars(propVarToId);  // NOT armazena em left
-    } else {
-        if (left) left->collectPropVars(propVarToId);
-        if (right) right->collectPropVars(propVarToId);
+        size_t i = hashKey(n.modal, n.op, n.left, n.right) & mask;
+        while (table[i] != NO_FORMULA)
+            i = (i + 1) & mask;
+        table[i] = id;
     }
 }
 
-std::string CPLFormula::toString() const {
-    if (cached) return cachedString;
-
-    using C = CPLConnective;
-    switch (op) {
-        case C::VAR:
-            cachedString = var;
-            break;
-        case C::NOT:
-            cachedString = "¬(" + left->toString() + ")";
-            break;
-        case C::AND:
-            cachedString = "(" + left->toString() + " ∧ " + right->toString() + ")";
-            break;
-        case C::OR:
-            cachedString = "(" + left->toString() + " ∨ " + right->toString() + ")";
-            break;
-        case C::IMPLIES:
-            cachedString = "(" + left->toString() + " → " + right->toString() + ")";
-            break;
-        case C::IFF:
-            cachedString = "(" + left->toString() + " ↔ " + right->toString() + ")";
-            break;
-    }
+FormulaId FormulaStore::variable(std::string_view name) {
+    auto it = varIndex.find(name);
+    if (it != varIndex.end())
+        return it->second;
 
-    cached = true;
-    return cachedString;
+    FormulaId id = static_cast<FormulaId>(nodes.size());
+    nodes.push_back({false, static_cast<std::uint8_t>(CPLConnective::VAR), NO_FORMULA, NO_FORMULA, numVars()});
+    varNames.emplace_back(name);
+    varIndex.emplace(varNames.back(), id);
+    return id;
 }
 
-std::unique_ptr<CPLFormula> CPLFormula::clone() const {
-    auto copy = std::make_unique<CPLFormula>();
-    copy->op = this->op;
-    copy->var = this->var;
-    if (left)  copy->left  = left->clone();
-    if (right) copy->right = right->clone();
-    return copy;
+FormulaId FormulaStore::cpl(CPLConnective op, FormulaId lhs, FormulaId rhs) {
+    if (op == CPLConnective::VAR)
+        throw std::runtime_error("CPL variables must be created by name.");
+    return intern({false, static_cast<std::uint8_t>(op), lhs, rhs});
 }
 
-// ---------------------------
-// ModalFormula Implementação
-// ---------------------------
-
-ModalFormula ModalFormula::patom(const CPLFormula& phi) {
-    ModalFormula f;
-    f.op = ModalConnective::P_ATOM;
-    f.atom = phi.clone();
-    return f;
+FormulaId FormulaStore::modal(ModalConnective op, FormulaId lhs, FormulaId rhs) {
+    return intern({true, static_cast<std::uint8_t>(op), lhs, rhs});
 }
 
-ModalFormula ModalFormula::unary(ModalConnective op, ModalFormula operand) {
-    ModalFormula f;
-    f.op = op;
-    f.left = std::make_unique<ModalFormula>(std::move(operand));
-    return f;
-}
+std::vector<FormulaId> FormulaStore::merge(const FormulaStore& other, const std::vector<FormulaId>& roots) {
+    // Em ordem crescente os filhos de 'other' já foram mapeados
+    std::vector<FormulaId> map(other.size());
+    for (FormulaId id = 0; id < static_cast<FormulaId>(other.size()); ++id) {
+        const FormulaNode& n = other.nodes[id];
+        if (!n.modal && n.cplOp() == CPLConnective::VAR)
+            map[id] = variable(other.varNames[n.var]);
+        else
+            map[id] = intern({n.modal, n.op, map[n.left], n.right != NO_FORMULA ? map[n.right] : NO_FORMULA});
+    }
 
-ModalFormula ModalFormula::binary(ModalConnective op, ModalFormula lhs, ModalFormula rhs) {
-    ModalFormula f;
-    f.op = op;
-    f.left = std::make_unique<ModalFormula>(std::move(lhs));
-    f.right = std::make_unique<ModalFormula>(std::move(rhs));
-    return f;
+    std::vector<FormulaId> mapped;
+    mapped.reserve(roots.size());
+    for (FormulaId r : roots)
+        mapped.push_back(map[r]);
+    return mapped;
 }
 
-void ModalFormula::collectPropVars(std::unordered_map<std::string, int>& propVarToId) const {
-    using M = ModalConnective;
+std::vector<FormulaId> FormulaStore::reachable(const std::vector<FormulaId>& roots) const {
+    if (roots.empty())
+        return {};
 
-    if (op == M::P_ATOM) {
-        if (atom) atom->collectPropVars(propVarToId);
-    } else if (op == M::NOT) {
-        if (left) left->collectPropVars(propVarToId);  // NOT armazena em left
-    } else {
-        if (left) left->collectPropVars(propVarToId);
-        if (right) right->collectPropVars(propVarToId);
-    }
-}
+    FormulaId top = 0;
+    for (FormulaId r : roots)
+        top = std::max(top, r);
 
-std::string ModalFormula::toString() const {
-    if (cached) return cachedString;
-
-    using M = ModalConnective;
-    switch (op) {
-        case M::P_ATOM:
-            cachedString = "P(" + atom->toString() + ")";
-            break;
-        case M::NOT:
-            cachedString = "¬(" + left->toString() + ")";
-            break;
-        case M::AND:
-            cachedString = "(" + left->toString() + " ∧ " + right->toString() + ")";
-            break;
-        case M::OR:
-            cachedString = "(" + left->toString() + " ∨ " + right->toString() + ")";
-            break;
-        case M::IMPLIES:
-            cachedString = "(" + left->toString() + " → " + right->toString() + ")";
-            break;
-        case M::IFF:
-            cachedString = "(" + left->toString() + " ↔ " + right->toString() + ")";
-            break;
-        case M::OPLUS:
-            cachedString = "(" + left->toString() + " ⊕ " + right->toString() + ")";
-            break;
-        case M::ODOT:
-            cachedString = "(" + left->toString() + " ⊙ " + right->toString() + ")";
-            break;
+    // Os filhos têm ID menor: uma passada decrescente propaga as marcas
+    std::vector<bool> mark(top + 1, false);
+    for (FormulaId r : roots)
+        mark[r] = true;
+
+    for (FormulaId id = top; id >= 0; --id) {
+        if (!mark[id]) continue;
+        if (nodes[id].left != NO_FORMULA) mark[nodes[id].left] = true;
+        if (nodes[id].right != NO_FORMULA) mark[nodes[id].right] = true;
     }
 
-    cached = true;
-    return cachedString;
+    std::vector<FormulaId> out;
+    for (FormulaId id = 0; id <= top; ++id)
+        if (mark[id])
+            out.push_back(id);
+    return out;
 }
 
-std::unique_ptr<ModalFormula> ModalFormula::clone() const {
-    auto copy = std::make_unique<ModalFormula>();
-    copy->op = this->op;
-
-    if (atom)
-        copy->atom = atom->clone();
+std::vector<int> FormulaStore::variables(const std::vector<FormulaId>& roots) const {
+    std::vector<bool> occurs(varNames.size(), false);
+    for (FormulaId id : reachable(roots))
+        if (!nodes[id].modal && nodes[id].cplOp() == CPLConnective::VAR)
+            occurs[nodes[id].var] = true;
+
+    std::vector<int> vars;
+    for (int v = 0; v < numVars(); ++v)
+        if (occurs[v])
+            vars.push_back(v);
+    return vars;
+}
 
-    if (left)
-        copy->left = left->clone();
+static const char* connectiveSymbol(const FormulaNode& n) {
+    if (n.modal) {
+        switch (n.modalOp()) {
+            case ModalConnective::AND:     return " ∧ ";
+            case ModalConnective::OR:      return " ∨ ";
+            case ModalConnective::IMPLIES: return " → ";
+            case ModalConnective::IFF:     return " ↔ ";
+            case ModalConnective::OPLUS:   return " ⊕ ";
+            case ModalConnective::ODOT:    return " ⊙ ";
+            default:                       return "";
+        }
+    }
+    switch (n.cplOp()) {
+        case CPLConnective::AND:     return " ∧ ";
+        case CPLConnective::OR:      return " ∨ ";
+        case CPLConnective::IMPLIES: return " → ";
+        case CPLConnective::IFF:     return " ↔ ";
+        default:                     return "";
+    }
+}
 
-    if (right)
-        copy->right = right->clone();
+std::string FormulaStore::toString(FormulaId root) const {
+    // Pilha explícita: subfórmulas a imprimir ou texto literal (fórmulas
+    // profundas não esgotam a pilha de chamadas)
+    struct Task {
+        FormulaId id;
+        const char* text;
+    };
+
+    std::string out;
+    std::vector<Task> stack{{root, nullptr}};
+    while (!stack.empty()) {
+        Task t = stack.back();
+        stack.pop_back();
+
+        if (t.text) {
+            out += t.text;
+            continue;
+        }
 
-    return copy;
+        const FormulaNode& n = nodes[t.id];
+        if (!n.modal && n.cplOp() == CPLConnective::VAR) {
+            out += varNames[n.var];
+        } else if (n.modal && n.modalOp() == ModalConnective::P_ATOM) {
+            out += "P(";
+            stack.push_back({NO_FORMULA, ")"});
+            stack.push_back({n.left, nullptr});
+        } else if (n.right == NO_FORMULA) {
+            out += "¬(";
+            stack.push_back({NO_FORMULA, ")"});
+            stack.push_back({n.left, nullptr});
+        } else {
+            out += "(";
+            stack.push_back({NO_FORMULA, ")"});
+            stack.push_back({n.right, nullptr});
+            stack.push_back({NO_FORMULA, connectiveSymbol(n)});
+            stack.push_back({n.left, nullptr});
+        }
+    }
+    return out;
 }
-
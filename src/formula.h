@@ -1,13 +1,16 @@
 #ifndef FORMULA_HPP
 #define FORMULA_HPP
 
-#include <memory>
+#include <cstdint>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 // ----------- Nível 1: CPL -----------
 
-enum class CPLConnective {
+enum class CPLConnective : std::uint8_t {
     VAR,
     NOT,
     AND,
@@ -16,34 +19,9 @@ enum class CPLConnective {
     IFF
 };
 
-struct CPLFormula {
-    mutable std::string cachedString; // cache de toString()
-    mutable bool cached = false;
-
-    CPLConnective op;
-    std::string var; // só usado se op == VAR
-    std::unique_ptr<CPLFormula> left;
-    std::unique_ptr<CPLFormula> right;
-
-    // Construtores estáticos auxiliares
-    static CPLFormula variable(const std::string& name);
-    static CPLFormula unary(CPLConnective op, CPLFormula operand);
-    static CPLFormula binary(CPLConnective op, CPLFormula lhs, CPLFormula rhs);
-
-    CPLFormula();
-    CPLFormula(const CPLFormula&) = delete;
-    CPLFormula(CPLFormula&&) = default;
-    CPLFormula& operator=(const CPLFormula&) = delete;
-    CPLFormula& operator=(CPLFormula&&) = default;
-
-    void collectPropVars(std::unordered_map<std::string, int>& propVarToId) const;
-    std::string toString() const;
-    std::unique_ptr<CPLFormula> clone() const;
-};
-
 // ----------- Nível 2: FP(Ł) -----------
 
-enum class ModalConnective {
+enum class ModalConnective : std::uint8_t {
     P_ATOM,     // Pφ
     NOT,
     AND,
@@ -54,24 +32,92 @@ enum class ModalConnective {
     ODOT        // ⊙ conjunção forte
 };
 
-struct ModalFormula {
-    mutable std::string cachedString; // cache de toString()
-    mutable bool cached = false;
+// ----------- Armazém de fórmulas -----------
 
-    ModalConnective op;
-    std::unique_ptr<CPLFormula> atom; // usado se op == P_ATOM
-    std::unique_ptr<ModalFormula> left;
-    std::unique_ptr<ModalFormula> right;
+// Identificador de uma subfórmula no FormulaStore
+using FormulaId = int;
+constexpr FormulaId NO_FORMULA = -1;
 
-    // Construtores auxiliares
-    static ModalFormula patom(const CPLFormula& phi);
-    static ModalFormula unary(ModalConnective op, ModalFormula operand);
-    static ModalFormula binary(ModalConnective op, ModalFormula lhs, ModalFormula rhs);
+// Nó do DAG. Os filhos sempre têm ID menor que o pai, então percorrer os
+// IDs em ordem crescente visita as subfórmulas antes das fórmulas.
+struct FormulaNode {
+    bool modal;                     // nível FP(Ł) ou CPL
+    std::uint8_t op;                // ModalConnective ou CPLConnective
+    FormulaId left = NO_FORMULA;    // P_ATOM: a fórmula CPL φ; NOT: o operando
+    FormulaId right = NO_FORMULA;
+    int var = -1;                   // só usado se op == VAR: ID denso da variável
 
-    void collectPropVars(std::unordered_map<std::string, int>& propVarToId) const;
-    std::string toString() const;
-    std::unique_ptr<ModalFormula> clone() const;
+    CPLConnective cplOp() const { return static_cast<CPLConnective>(op); }
+    ModalConnective modalOp() const { return static_cast<ModalConnective>(op); }
 };
 
-#endif // FORMULA_HPP
+// Fórmulas CPL e FP(Ł) com hash-consing: cada subfórmula estruturalmente
+// distinta existe uma única vez, e a igualdade é a igualdade dos IDs.
+class FormulaStore {
+public:
+    FormulaStore() = default;
+    FormulaStore(FormulaStore&&) = default;
+    FormulaStore& operator=(FormulaStore&&) = default;
+    FormulaStore(const FormulaStore&) = delete;     // varIndex aponta para varNames
+    FormulaStore& operator=(const FormulaStore&) = delete;
+
+    // Construtores: devolvem o ID existente se o nó já está no armazém
+    FormulaId variable(std::string_view name);
+    FormulaId cpl(CPLConnective op, FormulaId lhs, FormulaId rhs = NO_FORMULA);
+    FormulaId modal(ModalConnective op, FormulaId lhs, FormulaId rhs = NO_FORMULA);
+    FormulaId patom(FormulaId phi) { return modal(ModalConnective::P_ATOM, phi); }
+
+    // Copia as fórmulas de outro armazém, compartilhando o que já existe
+    // aqui; devolve os IDs de 'roots' neste armazém
+    std::vector<FormulaId> merge(const FormulaStore& other, const std::vector<FormulaId>& roots);
+
+    const FormulaNode& operator[](FormulaId id) const { return nodes[id]; }
+    size_t size() const { return nodes.size(); }
+
+    // Variáveis proposicionais, numeradas na ordem em que aparecem
+    const std::string& varName(int var) const { return varNames[var]; }
+    int numVars() const { return static_cast<int>(varNames.size()); }
+
+    // Subfórmulas alcançáveis a partir de 'roots', em ordem crescente de ID
+    std::vector<FormulaId> reachable(const std::vector<FormulaId>& roots) const;
+
+    // IDs das variáveis que ocorrem em 'roots', em ordem crescente
+    std::vector<int> variables(const std::vector<FormulaId>& roots) const;
+
+    std::string toString(FormulaId id) const;
+
+private:
+    // O formato binário copia os vetores do armazém diretamente
+    friend std::vector<FormulaId> readBinaryInstance(std::string_view data, FormulaStore& store);
+    friend void writeBinaryInstance(const std::string& filename, const FormulaStore& store,
+                                    const std::vector<FormulaId>& roots);
+
+    struct Key {
+        bool modal;
+        std::uint8_t op;
+        FormulaId left, right;
+    };
+
+    static size_t hashKey(bool modal, std::uint8_t op, FormulaId left, FormulaId right) {
+        // Filhos nos 64 bits, conectivo misturado, finalização splitmix64
+        std::uint64_t h = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(left)) << 32) |
+                          static_cast<std::uint32_t>(right);
+        h ^= ((static_cast<std::uint64_t>(op) << 1) | modal) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 27; h *= 0x94D049BB133111EBULL;
+        h ^= h >> 31;
+        return static_cast<size_t>(h);
+    }
+
+    FormulaId intern(const Key& key);
+    void growTable();
+
+    std::vector<FormulaNode> nodes;     // arena: o ID é o índice
+    // Tabela de endereçamento aberto com os IDs (as chaves ficam em 'nodes');
+    // tamanho potência de 2, ocupação até 1/2
+    std::vector<FormulaId> table;
+    std::deque<std::string> varNames;                           // endereços estáveis
+    std::unordered_map<std::string_view, FormulaId> varIndex;   // nome -> nó VAR
+};
 
+#endif // FORMULA_HPP
@@ -0,0 +1,106 @@
+#include "fplsol.h"
+#include "parser.h"
+#include "solver.h"
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+static void configure(FPSolver& solver, const FPOptions& options) {
+    solver.setLog(options.log);
+    solver.setPBOptions(options.usePB, options.pbSolver, options.pbArguments);
+    solver.setNormalize(options.normalize);
+    solver.setPresolve(options.presolve, options.presolveRelations);
+    solver.setSymmetry(options.symmetry);
+    solver.setCutMode(options.cuts);
+    solver.setPricingMode(options.pricing);
+    solver.setFastMode(options.fast);
+    solver.setColumnAging(options.columnAge);
+    solver.setLimits(options.timeLimit, options.cancel);
+    solver.setResourceLimits(options.nodeLimit, options.memLimitMB);
+    solver.setProgressInterval(options.progressInterval);
+    solver.setColumnCache(options.columnCache);
+    solver.setDecompose(options.decompose);
+}
+
+FPResult fplSolve(FormulaStore store, std::vector<FormulaId> formulas, const FPOptions& options) {
+    FPSolver solver(std::move(store), std::move(formulas), options.verbose);
+    configure(solver, options);
+    solver.solve();
+    return solver.result();
+}
+
+FPResult fplSolve(const std::vector<std::string>& formulas, const FPOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    FormulaStore store;
+    std::vector<FormulaId> roots;
+    roots.reserve(formulas.size());
+    for (size_t k = 0; k < formulas.size(); ++k) {
+        try {
+            ModalParser parser(formulas[k], store);
+            roots.push_back(parser.parse());
+        } catch (const std::exception& e) {
+            throw std::runtime_error("Formula " + std::to_string(k + 1) + ": " + e.what());
+        }
+    }
+    double parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    FPResult result = fplSolve(std::move(store), std::move(roots), options);
+    result.stats.parseSeconds = parseSeconds;
+    return result;
+}
+
+std::string fplStatsJson(const FPResult& result) {
+    const FPStats& s = result.stats;
+    std::ostringstream out;
+    out << "{\"seconds\":" << result.seconds
+        << ",\"parse_seconds\":" << s.parseSeconds
+        << ",\"normalize_seconds\":" << s.normalizeSeconds
+        << ",\"encode_seconds\":" << s.encodeSeconds
+        << ",\"presolve\":{\"seconds\":" << s.presolveSeconds << ",\"merged\":" << s.atomsMerged
+        << ",\"fixed\":" << s.atomsFixed << ",\"relations\":" << s.atomRelations << "}"
+        << ",\"symmetry\":{\"seconds\":" << s.symmetrySeconds << ",\"generators\":" << s.symmetryGenerators
+        << ",\"pricing_pairs\":" << s.pricingSymmetries << "}"
+        << ",\"lp\":{\"solves\":" << s.lpSolves << ",\"seconds\":" << s.lpSeconds
+        << ",\"peak_rows\":" << s.peakRows << ",\"peak_cols\":" << s.peakCols << "}"
+        << ",\"pricing\":{\"exhaustive\":{\"calls\":" << s.exhaustivePricings
+        << ",\"seconds\":" << s.exhaustiveSeconds << "},\"pb\":{\"calls\":" << s.pbPricings
+        << ",\"seconds\":" << s.pbSeconds << "},\"patterns\":{\"calls\":" << s.patternPricings
+        << ",\"seconds\":" << s.patternSeconds << ",\"nodes\":" << s.patternNodes << "}}"
+        << ",\"columns\":{\"added\":" << result.columns << ",\"pooled\":" << s.columnsPooled << "}"
+        << ",\"nodes\":{\"opened\":" << result.nodes << ",\"closed\":" << s.nodesClosed
+        << ",\"pruned\":" << s.nodesPruned << ",\"symmetric\":" << s.nodesSymmetric << "}"
+        << ",\"iterations\":" << result.iterations
+        << ",\"peak_rss_kb\":" << s.peakRssKB << "}";
+    return out.str();
+}
+
+// ----------- Sessão incremental -----------
+
+FPSession::FPSession(const FPOptions& options)
+    : solver(std::make_unique<FPSolver>(FormulaStore(), std::vector<FormulaId>(), options.verbose))
+{
+    configure(*solver, options);
+}
+
+FPSession::~FPSession() = default;
+
+void FPSession::addFormula(const std::string& formula) {
+    solver->addFormula(formula);
+}
+
+void FPSession::push() {
+    solver->push();
+}
+
+void FPSession::pop() {
+    solver->pop();
+}
+
+std::size_t FPSession::numFormulas() const {
+    return solver->numFormulas();
+}
+
+FPResult FPSession::solve() {
+    solver->solve();
+    return solver->result();
+}
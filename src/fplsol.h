@@ -0,0 +1,169 @@
+#ifndef FPLSOL_HPP
+#define FPLSOL_HPP
+
+#include "formula.h"
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ----------- API da biblioteca libfplsol -----------
+//
+// Decide a satisfatibilidade de fórmulas FP(Ł) dentro do processo que a
+// chama. Nada é escrito na saída padrão nem em arquivos: as mensagens só vão
+// para FPOptions::log, e o resultado volta em FPResult. A única exceção são
+// os arquivos do solver PB externo (usePB), criados e removidos no diretório
+// temporário do sistema. Erros são lançados como std::runtime_error.
+
+// Modo de aplicação dos cortes
+enum class CutMode {
+    OFF,    // sem cortes
+    ROOT,   // todas as facetas no PL raiz (herdadas por todos os ramos)
+    NODE    // separação das facetas violadas em cada nó
+};
+
+// Oráculo de precificação sem o solver PB
+enum class PricingMode {
+    AUTO,       // padrões com menos átomos P que variáveis ou acima de 20
+                // variáveis, senão exaustivo
+    EXHAUSTIVE, // todas as 2^n valorações (até 30 variáveis)
+    PATTERNS    // padrões dos átomos P guiados pelos duais, com SAT interno
+};
+
+struct FPOptions {
+    bool usePB = false;             // oráculo minisat+; senão busca exaustiva
+    std::string pbSolver = "minisat+";
+    std::string pbArguments;
+    bool normalize = true;          // normalização AC e simplificação
+    bool presolve = true;           // relações clássicas entre os átomos P no PL raiz
+    bool presolveRelations = false; // implicações, exclusões e coberturas quando violadas
+    bool symmetry = true;           // trocas de variáveis na precificação e na ramificação
+    CutMode cuts = CutMode::ROOT;
+    PricingMode pricing = PricingMode::AUTO;
+    bool fast = false;              // tolerâncias folgadas, veredito certificado
+    int columnAge = 10;             // 0 desliga o envelhecimento de colunas
+    bool verbose = false;           // rastreamento detalhado em 'log'
+    std::ostream* log = nullptr;    // mensagens de progresso (nullptr: nenhuma)
+
+    // Interrupção cooperativa: o resultado é UNKNOWN
+    double timeLimit = 0.0;                     // segundos (0: sem limite)
+    const std::atomic<bool>* cancel = nullptr;  // true cancela a resolução
+    long nodeLimit = 0;                         // PLs de nó (0: sem limite)
+    double memLimitMB = 0.0;                    // memória residente (0: sem limite);
+                                                // perto dela, busca em profundidade
+
+    double progressInterval = 0.0;  // segundos entre linhas de progresso em 'log' (0: nenhuma)
+    std::string columnCache;        // diretório do cache de colunas entre execuções ("": nenhum)
+    bool decompose = true;          // componentes independentes resolvidos em paralelo
+};
+
+enum class FPStatus {
+    SAT,
+    UNSAT,
+    UNKNOWN     // limite de tempo, nós ou memória, ou cancelamento
+};
+
+// Contadores e tempos de uma resolução, sempre coletados (custo desprezível
+// diante das resoluções de PL). Tempos em segundos.
+struct FPStats {
+    double parseSeconds = 0.0;      // leitura das fórmulas (fplSolve em texto e linha de comando)
+    double normalizeSeconds = 0.0;
+    double encodeSeconds = 0.0;     // PL raiz: gadgets, restrições e cortes
+    double presolveSeconds = 0.0;   // relações entre os átomos P (fora de encodeSeconds)
+    int atomsMerged = 0;            // átomos P equivalentes a outro
+    int atomsFixed = 0;             // átomos P com ψ insatisfazível ou válida
+    int atomRelations = 0;          // implicações, exclusões e coberturas (linhas só quando violadas)
+    double symmetrySeconds = 0.0;   // detecção das simetrias (fora de encodeSeconds)
+    int symmetryGenerators = 0;     // trocas que preservam as fórmulas, sobre as binárias
+    int pricingSymmetries = 0;      // pares v[p] ≤ v[q] nas valorações geradas
+    int nodesSymmetric = 0;         // ramos descartados por simetria, sem resolver o PL
+
+    int lpSolves = 0;
+    double lpSeconds = 0.0;
+
+    // Precificação, por oráculo
+    int exhaustivePricings = 0;
+    double exhaustiveSeconds = 0.0;
+    int pbPricings = 0;
+    double pbSeconds = 0.0;
+    int patternPricings = 0;
+    double patternSeconds = 0.0;
+    long patternNodes = 0;          // nós da busca em profundidade nos átomos
+
+    int columnsPooled = 0;          // colunas retiradas por envelhecimento
+
+    int nodesClosed = 0;            // PL do nó inviável
+    int nodesPruned = 0;            // objetivo da Fase I positivo sem coluna que o melhore
+
+    int peakRows = 0;               // maior PL resolvido
+    int peakCols = 0;
+    long peakRssKB = 0;             // pico de memória residente do processo
+};
+
+// Átomo da distribuição de probabilidade que satisfaz as fórmulas
+struct FPAtom {
+    std::size_t index;              // busca exaustiva: a valoração como inteiro; PB e padrões: ordem de geração
+    double probability;
+    std::vector<bool> valuation;    // na ordem de FPResult::variables
+};
+
+struct FPResult {
+    FPStatus status = FPStatus::UNKNOWN;
+    std::string reason;             // ex.: "open branch found", "all branches closed"
+
+    // Esforço da resolução
+    double seconds = 0.0;
+    int nodes = 0;                  // PLs de nós resolvidos por geração de colunas
+    int iterations = 0;             // iterações de geração de colunas, somadas nos nós
+    int columns = 0;                // colunas p(·) geradas pelo oráculo
+    FPStats stats;
+
+    bool sat() const { return status == FPStatus::SAT; }
+
+    // Só preenchidos se SAT
+    std::vector<std::string> variables;                     // variáveis proposicionais
+    std::vector<std::pair<std::string, double>> modalValues; // valor de cada subfórmula modal
+    std::vector<FPAtom> distribution;                        // átomos com a massa do PL
+};
+
+// Fórmulas já no armazém (ex.: lidas com loadModalFormulasFromFile)
+FPResult fplSolve(FormulaStore store, std::vector<FormulaId> formulas, const FPOptions& options = {});
+
+// Fórmulas em texto, uma por elemento, na sintaxe dos arquivos de entrada
+FPResult fplSolve(const std::vector<std::string>& formulas, const FPOptions& options = {});
+
+// Esforço e estatísticas do resultado como um objeto JSON (sem a solução)
+std::string fplStatsJson(const FPResult& result);
+
+// Sessão incremental: fórmulas acrescentadas e retiradas em escopos
+// (push/pop), com cada solve reaproveitando o que as chamadas anteriores
+// aprenderam — colunas da última solução, o último ramo aberto como partida
+// a quente e, enquanto nenhum pop o desfaz, um subconjunto já UNSAT.
+class FPSolver;
+
+class FPSession {
+public:
+    explicit FPSession(const FPOptions& options = {});
+    ~FPSession();
+
+    FPSession(const FPSession&) = delete;
+    FPSession& operator=(const FPSession&) = delete;
+
+    // Fórmula modal em texto; lança std::runtime_error se inválida
+    void addFormula(const std::string& formula);
+
+    // Abre um escopo; pop retira as fórmulas acrescentadas desde o push
+    void push();
+    void pop();
+
+    std::size_t numFormulas() const;
+    FPResult solve();
+
+private:
+    std::unique_ptr<FPSolver> solver;
+};
+
+#endif // FPLSOL_HPP
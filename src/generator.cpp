@@ -0,0 +1,195 @@
+#include "generator.h"
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Sorteios sobre o mt19937_64, cuja sequência é fixada pelo padrão; as
+// distribuições da biblioteca variam entre implementações
+class Random {
+public:
+    explicit Random(std::uint64_t seed) : engine(seed) {}
+
+    int pick(int n) { return static_cast<int>(engine() % static_cast<std::uint64_t>(n)); }
+    bool coin() { return engine() & 1; }
+
+private:
+    std::mt19937_64 engine;
+};
+
+std::string variable(int i) {
+    return "X" + std::to_string(i + 1);
+}
+
+// generate_classical_cnf: cláusulas ((l1 ∨ l2) ∨ l3)
+std::vector<std::string> classicalCNF(Random& rng, int n, int m) {
+    std::vector<std::string> clauses;
+    for (int c = 0; c < m; ++c) {
+        std::string lits[3];
+        for (auto& lit : lits) {
+            lit = variable(rng.pick(n));
+            if (rng.coin())
+                lit = "¬" + lit;
+        }
+        clauses.push_back("((" + lits[0] + " ∨ " + lits[1] + ") ∨ " + lits[2] + ")");
+    }
+    return clauses;
+}
+
+// generate_classical_poly: implicação de átomos, com ⊤ no antecedente e ⊥
+// no consequente eliminados
+std::string classicalPoly(Random& rng, int n) {
+    while (true) {
+        int ant = rng.pick(n + 1);     // n: ⊤
+        int cons = rng.pick(n + 1);    // n: ⊥
+        if (ant == n && cons != n)
+            return variable(cons);
+        if (cons == n && ant != n)
+            return "¬" + variable(ant);
+        if (ant != n && cons != n)
+            return "(" + variable(ant) + " → " + variable(cons) + ")";
+    }
+}
+
+// apply_prob_operator sobre a conjunção das cláusulas
+std::string probAtom(const std::vector<std::string>& clauses) {
+    std::string cnf = clauses.at(0);
+    for (size_t c = 1; c < clauses.size(); ++c)
+        cnf = "(" + cnf + " ∧ " + clauses[c] + ")";
+    return "P(" + cnf + ")";
+}
+
+const char* const L_CLAUSES[] = {
+    "(({0} ⊕ {1}) ⊕ {2})",
+    "((¬{0} ⊕ {1}) ⊕ {2})",
+    "(({0} ⊕ ¬{1}) ⊕ {2})",
+    "(({0} ⊕ {1}) ⊕ ¬{2})",
+    "((¬{0} ⊕ ¬{1}) ⊕ {2})",
+    "((¬{0} ⊕ {1}) ⊕ ¬{2})",
+    "(({0} ⊕ ¬{1}) ⊕ ¬{2})",
+    "((¬{0} ⊕ ¬{1}) ⊕ ¬{2})",
+    "(¬({0} ⊕ {1}) ⊕ {2})",
+    "(¬({0} ⊕ {2}) ⊕ {1})",
+    "({0} ⊕ ¬({1} ⊕ {2}))",
+};
+
+std::string fillTemplate(const std::string& pattern, const std::string (&atoms)[3]) {
+    std::string out;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] == '{' && i + 2 < pattern.size() && pattern[i + 2] == '}') {
+            out += atoms[pattern[i + 1] - '0'];
+            i += 2;
+        } else {
+            out += pattern[i];
+        }
+    }
+    return out;
+}
+
+// generate_l_clauses_np_modal
+std::vector<std::string> npModalClauses(Random& rng, int k, int n) {
+    std::vector<std::string> clauses;
+    for (int c = 0; c < k; ++c) {
+        std::string atoms[3];
+        for (auto& atom : atoms)
+            atom = "P(" + classicalPoly(rng, n) + ")";
+        clauses.push_back(fillTemplate(L_CLAUSES[rng.pick(static_cast<int>(std::size(L_CLAUSES)))], atoms));
+    }
+    return clauses;
+}
+
+// generate_simple_l_clauses_np_classical + combine_modal_variables
+std::vector<std::string> npClassicalClauses(Random& rng, int m, int n, int l1, int l2) {
+    std::vector<std::string> clauses;
+    for (int c = 0; c < l2; ++c) {
+        std::vector<std::string> atoms;
+        for (int a = 0; a < l1; ++a)
+            atoms.push_back(probAtom(classicalCNF(rng, n, m)));
+
+        std::string expr = rng.coin() ? atoms[0] : "¬" + atoms[0];
+        for (int a = 1; a < l1; ++a)
+            expr = "(" + expr + (rng.coin() ? " ⊕ " : " ⊕ ¬") + atoms[a] + ")";
+        clauses.push_back(expr);
+    }
+    return clauses;
+}
+
+// combine_l_clauses: conjunção fraca
+std::string combine(const std::vector<std::string>& clauses) {
+    std::string expr = clauses.at(0);
+    for (size_t c = 1; c < clauses.size(); ++c)
+        expr = "(" + expr + " ∧ " + clauses[c] + ")";
+    return expr;
+}
+
+[[noreturn]] void invalid(const std::string& text, const std::string& reason) {
+    throw std::runtime_error("Invalid generator spec '" + text + "': " + reason);
+}
+
+} // namespace
+
+GeneratorSpec parseGeneratorSpec(const std::string& text) {
+    GeneratorSpec spec;
+    size_t colon = text.find(':');
+    spec.family = text.substr(0, colon);
+    if (spec.family != "cnf" && spec.family != "np-modal" && spec.family != "np-classical")
+        invalid(text, "unknown family (cnf, np-modal or np-classical)");
+
+    std::string params = colon == std::string::npos ? "" : text.substr(colon + 1);
+    std::istringstream in(params);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos)
+            invalid(text, "expected key=value, got '" + item + "'");
+
+        std::string key = item.substr(0, eq);
+        long long value;
+        try {
+            size_t used;
+            value = std::stoll(item.substr(eq + 1), &used);
+            if (used != item.size() - eq - 1)
+                throw std::invalid_argument(item);
+        } catch (const std::exception&) {
+            invalid(text, "bad value for " + key);
+        }
+
+        if (key == "seed") {
+            spec.seed = static_cast<std::uint64_t>(value);
+            continue;
+        }
+        if (value < 1 || value > 1000000)
+            invalid(text, key + " must be between 1 and 1000000");
+
+        if (key == "n") spec.n = static_cast<int>(value);
+        else if (key == "m") spec.m = static_cast<int>(value);
+        else if (key == "k") spec.k = static_cast<int>(value);
+        else if (key == "l1") spec.l1 = static_cast<int>(value);
+        else if (key == "l2") spec.l2 = static_cast<int>(value);
+        else invalid(text, "unknown key " + key);
+    }
+    return spec;
+}
+
+std::string toString(const GeneratorSpec& spec) {
+    std::string out = spec.family + ":n=" + std::to_string(spec.n);
+    if (spec.family == "np-modal")
+        out += ",k=" + std::to_string(spec.k);
+    else
+        out += ",m=" + std::to_string(spec.m);
+    if (spec.family == "np-classical")
+        out += ",l1=" + std::to_string(spec.l1) + ",l2=" + std::to_string(spec.l2);
+    return out + ",seed=" + std::to_string(spec.seed);
+}
+
+std::string generateInstance(const GeneratorSpec& spec) {
+    Random rng(spec.seed);
+    if (spec.family == "cnf")
+        return probAtom(classicalCNF(rng, spec.n, spec.m));
+    if (spec.family == "np-modal")
+        return combine(npModalClauses(rng, spec.k, spec.n));
+    return combine(npClassicalClauses(rng, spec.m, spec.n, spec.l1, spec.l2));
+}
@@ -0,0 +1,38 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <cstdint>
+#include <string>
+
+// Gerador de instâncias das famílias de experiments/experiment.py, com
+// semente explícita: a mesma especificação dá sempre a mesma instância.
+//
+//   cnf           P(CNF): m cláusulas de 3 literais sobre n variáveis
+//   np-modal      k l-cláusulas (gabaritos L_CLAUSES) de três átomos P(·)
+//                 sobre implicações de variáveis (generate_classical_poly)
+//   np-classical  l2 l-cláusulas simples de l1 átomos P(CNF), cada CNF com
+//                 m cláusulas sobre n variáveis
+//
+// As l-cláusulas são combinadas com ∧ numa única fórmula, como em
+// write_instance_file.
+struct GeneratorSpec {
+    std::string family;
+    int n = 10;         // variáveis clássicas
+    int m = 10;         // cláusulas por CNF (cnf, np-classical)
+    int k = 3;          // l-cláusulas (np-modal)
+    int l1 = 3;         // átomos por l-cláusula simples (np-classical)
+    int l2 = 3;         // l-cláusulas simples (np-classical)
+    std::uint64_t seed = 1;
+};
+
+// "família:chave=valor,..." (chaves n, m, k, l1, l2, seed); lança
+// std::runtime_error se inválida
+GeneratorSpec parseGeneratorSpec(const std::string& text);
+
+// Forma canônica da especificação, com todos os parâmetros da família
+std::string toString(const GeneratorSpec& spec);
+
+// Fórmula da instância, na sintaxe dos arquivos de entrada
+std::string generateInstance(const GeneratorSpec& spec);
+
+#endif // GENERATOR_HPP
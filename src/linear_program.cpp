@@ -5,6 +5,8 @@
 #include <stdexcept>
 #include <cmath>
 #include <algorithm>
+#include <fstream>
+#include <filesystem>
 
 using namespace soplex;
 
@@ -80,6 +82,38 @@ void LinearProgram::setMinimizationObjective() {
     solver->setIntParam(soplex::SoPlex::OBJSENSE, soplex::SoPlex::OBJSENSE_MINIMIZE);
 }
 
+void LinearProgram::removeVariables(const std::vector<int>& indices) {
+    int n = solver->numCols();
+    std::vector<int> perm(n, 0);
+    for (int idx : indices)
+        perm[idx] = -1;
+
+    // Após a remoção, perm[i] é o novo índice da coluna i (ou -1)
+    solver->removeColsReal(perm.data());
+
+    std::vector<std::string> names(solver->numCols());
+    nameToIndex.clear();
+    for (int i = 0; i < n; ++i) {
+        if (perm[i] < 0) continue;
+        names[perm[i]] = varNames[i];
+        nameToIndex[varNames[i]] = perm[i];
+    }
+    varNames = std::move(names);
+}
+
+void LinearProgram::setTolerances(double feastol, double opttol) {
+    solver->setRealParam(SoPlex::FEASTOL, feastol);
+    solver->setRealParam(SoPlex::OPTTOL, opttol);
+}
+
+void LinearProgram::setExact() {
+    solver->setIntParam(SoPlex::READMODE, SoPlex::READMODE_RATIONAL);
+    solver->setIntParam(SoPlex::SOLVEMODE, SoPlex::SOLVEMODE_RATIONAL);
+    solver->setIntParam(SoPlex::SYNCMODE, SoPlex::SYNCMODE_AUTO);
+    solver->setRealParam(SoPlex::FEASTOL, 0.0);
+    solver->setRealParam(SoPlex::OPTTOL, 0.0);
+}
+
 bool LinearProgram::solve() {
     // solver->writeFileReal("modelo.lp");
     auto status = solver->solve();
@@ -122,6 +156,13 @@ double LinearProgram::getVariableValue(int index) const {
     return primal[index];
 }
 
+std::vector<double> LinearProgram::getPrimal() const {
+    std::vector<double> primal(solver->numCols());
+    if (!solver->getPrimalReal(primal.data(), solver->numCols()))
+        throw std::runtime_error("Failed to obtain primal solution.");
+    return primal;
+}
+
 int LinearProgram::getVarIndex(const std::string& name) const {
     auto it = nameToIndex.find(name);
     if (it == nameToIndex.end())
@@ -149,6 +190,41 @@ std::vector<double> LinearProgram::getDuals() const {
     return result;
 }
 
+std::vector<double> LinearProgram::getReducedCosts() const {
+    std::vector<double> redCosts(solver->numCols());
+    if (!solver->getRedCostReal(redCosts.data(), solver->numCols()))
+        throw std::runtime_error("Failed to obtain reduced costs.");
+    return redCosts;
+}
+
+bool LinearProgram::isBasic(int index) const {
+    return solver->basisColStatus(index) == SPxSolver::BASIC;
+}
+
+// Conversão via texto "p/q", independente do backend racional do SoPlex
+static mpq_class toMpq(const Rational& r) {
+    std::ostringstream os;
+    os << r;
+    mpq_class q(os.str());
+    q.canonicalize();
+    return q;
+}
+
+mpq_class LinearProgram::getObjectiveValueExact() const {
+    return toMpq(solver->objValueRational());
+}
+
+std::vector<mpq_class> LinearProgram::getDualsExact() const {
+    VectorRational duals(solver->numRows());
+    if (!solver->getDualRational(duals))
+        throw std::runtime_error("Failed to obtain exact simplex (dual) multipliers.");
+
+    std::vector<mpq_class> result(duals.dim());
+    for (int i = 0; i < duals.dim(); ++i)
+        result[i] = toMpq(duals[i]);
+    return result;
+}
+
 std::unique_ptr<LinearProgram> LinearProgram::clone() const {
     return std::make_unique<LinearProgram>(*this);
 }
@@ -192,3 +268,40 @@ void LinearProgram::print(std::ostream& os) const {
     os << "\n=== Total: " << n << " variables, " << m << " constraints ===\n";
 }
 
+
+void LinearProgram::writeToFile(const std::string& filename) const {
+    // Nomes curtos (x3, b4, p17, ...): os originais têm espaços e UTF-8,
+    // que os formatos LP/MPS não aceitam; o mapa vai para um arquivo .names
+    NameSet rowNames, colNames;
+    DIdxSet binaries;
+
+    for (int r = 0; r < solver->numRows(); ++r)
+        rowNames.add(("r" + std::to_string(r)).c_str());
+
+    std::ofstream names(std::filesystem::path(filename).replace_extension(".names"));
+    for (int i = 0; i < static_cast<int>(varNames.size()); ++i) {
+        std::string shortName = varNames[i].substr(0, 1) + std::to_string(i);
+        colNames.add(shortName.c_str());
+        names << shortName << " " << varNames[i] << "\n";
+        if (varNames[i].rfind("b(", 0) == 0)
+            binaries.addIdx(i);
+    }
+
+    if (!solver->writeFileReal(filename.c_str(), &rowNames, &colNames, &binaries))
+        throw std::runtime_error("Failed writing LP file: " + filename);
+}
+
+std::unique_ptr<LinearProgram> LinearProgram::fromFile(const std::string& filename) {
+    auto lp = std::make_unique<LinearProgram>();
+    NameSet rowNames, colNames;
+
+    if (!lp->solver->readFile(filename.c_str(), &rowNames, &colNames))
+        throw std::runtime_error("Failed reading LP file: " + filename);
+
+    for (int i = 0; i < lp->solver->numCols(); ++i) {
+        std::string name = i < colNames.num() ? colNames[i] : "c" + std::to_string(i);
+        lp->varNames.push_back(name);
+        lp->nameToIndex[name] = i;
+    }
+    return lp;
+}
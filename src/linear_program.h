@@ -2,6 +2,7 @@
 #define LINEAR_PROGRAM_HPP
 
 #include <soplex.h>
+#include <gmpxx.h>
 #include <memory>
 #include <string>
 #include <vector>
@@ -27,9 +28,16 @@ public:
     void addCoefficientToRow(int row, int varIdx, double value);
     void setObjectiveCoefficient(int varIdx, double coeff);
     void setMinimizationObjective();
+    void removeVariables(const std::vector<int>& indices);
 
-    // Retorna o número de linhas no PL
+    // Tolerâncias do simplex em ponto flutuante
+    void setTolerances(double feastol, double opttol);
+    // Passa a resolver em aritmética racional exata
+    void setExact();
+
+    // Retorna o número de linhas e colunas no PL
     int numRows() const { return solver->numRows(); }
+    int numCols() const { return solver->numCols(); }
 
     // Resolve o PL
     bool solve();
@@ -37,14 +45,25 @@ public:
     // Acesso à solução
     double getObjectiveValue() const;
     double getVariableValue(int index) const;
+    std::vector<double> getPrimal() const;
     int getVarIndex(const std::string& name) const;
     std::set<std::string> getBinaryVariableNames() const;
     std::vector<double> getDuals() const;
+    std::vector<double> getReducedCosts() const;
+    bool isBasic(int index) const;
+
+    // Solução exata (após setExact)
+    mpq_class getObjectiveValueExact() const;
+    std::vector<mpq_class> getDualsExact() const;
 
     // Impressão e cópia
     void print(std::ostream& os) const;
     std::unique_ptr<LinearProgram> clone() const;
 
+    // Arquivos LP/MPS (formato pela extensão); as colunas b(·) saem como inteiras
+    void writeToFile(const std::string& filename) const;
+    static std::unique_ptr<LinearProgram> fromFile(const std::string& filename);
+
 private:
     std::unique_ptr<soplex::SoPlex> solver;
     std::vector<std::string> varNames;
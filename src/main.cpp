@@ -1,9 +1,95 @@
 #include "parser.h"
+#include "binary_format.h"
+#include "batch.h"
+#include "generator.h"
+#include "regress.h"
+#include "server.h"
 #include "solver.h"
+#include "linear_program.h"
+#include "trace.h"
+#include <atomic>
+#include <csignal>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+// Reexecuta um arquivo salvo com --dump: PL/MPS no SoPlex, OPB no solver PB
+static int replay(const std::string& file, const std::string& pbsolverPath, const std::string& pbArguments) {
+    auto start = std::chrono::steady_clock::now();
+
+    if (std::filesystem::path(file).extension() == ".opb") {
+        std::string command = pbsolverPath + (pbArguments.empty() ? "" : " " + pbArguments) + " " + file;
+        std::system(command.c_str());
+    } else {
+        auto lp = LinearProgram::fromFile(file);
+        bool optimal = lp->solve();
+        std::cout << lp->numRows() << " rows, " << lp->numCols() << " columns: "
+                  << (optimal ? "optimal, objective = " + std::to_string(lp->getObjectiveValue()) : "not optimal")
+                  << "\n";
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Time: " << elapsed.count() << " s\n";
+    return 0;
+}
+
+// Valores das subfórmulas modais e distribuição de uma solução SAT
+static void printSolution(std::ostream& out, const FPResult& result) {
+    out << "==== MODAL ATOMS VALUATION ====\n";
+    for (const auto& [formula, val] : result.modalValues)
+        out << formula << " = " << val << "\n";
+
+    out << "\n==== PROBABILITY DISTRIBUTION ====\n";
+    for (const auto& atom : result.distribution) {
+        out << "p(" << atom.index << ") = " << atom.probability << "   (";
+        for (size_t j = 0; j < result.variables.size(); ++j)
+            out << result.variables[j] << "=" << (atom.valuation[j] ? "1" : "0")
+                << (j + 1 < result.variables.size() ? ", " : "");
+        out << ")\n";
+    }
+}
+
+// Salva a solução em <entrada>.out
+static void saveOutputToFile(const std::string& inputFilename, const FPResult& result) {
+    std::string outName = inputFilename.substr(0, inputFilename.find_last_of('.')) + ".out";
+    std::ofstream out(outName);
+    if (!out) {
+        std::cerr << "Error opening output file: " << outName << "\n";
+        return;
+    }
+
+    printSolution(out, result);
+    out.close();
+    std::cout << "\nResult saved in: " << outName << "\n";
+}
+
+// Grava o arquivo de --trace ao sair de main, por qualquer caminho
+struct TraceFile {
+    std::string name;
+
+    ~TraceFile() {
+        if (name.empty())
+            return;
+        try {
+            trace::stop(name);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    }
+};
+
+// SIGINT/SIGTERM com --checkpoint: a busca para e grava o estado antes de sair
+static std::atomic<bool> stopRequested{false};
+
+static void requestStop(int) {
+    stopRequested.store(true);
+}
 
 int main(int argc, char* argv[]) {
     std::string inputFile;
@@ -11,6 +97,36 @@ int main(int argc, char* argv[]) {
     std::string pbArguments = "";
     bool usePB = true;
     bool verbose = false;
+    bool fast = false;
+    bool normalize = true;
+    bool presolve = true;
+    bool presolveRelations = false;
+    bool symmetry = true;
+    int columnAge = 10;
+    std::string dumpDir;
+    int dumpLimit = 16;
+    std::string replayFile;
+    std::string convertFile;
+    std::string batchSource;
+    BatchOptions batch;
+    double timeLimit = 0.0;
+    long nodeLimit = 0;
+    double memLimit = 0.0;
+    double progressInterval = 10.0;
+    std::string checkpointFile;
+    double checkpointInterval = 300.0;
+    std::string resumeFile;
+    std::string columnCache;
+    bool decompose = true;
+    bool serve = false;
+    std::string socketPath;
+    std::string statsFormat;
+    std::string generateSpec;
+    std::string regressGrid;
+    RegressOptions regress;
+    TraceFile traceFile;
+    CutMode cutMode = CutMode::ROOT;
+    PricingMode pricingMode = PricingMode::AUTO;
 
     // Parsing de argumentos simples
     for (int i = 1; i < argc; ++i) {
@@ -24,6 +140,93 @@ int main(int argc, char* argv[]) {
             pbsolverPath = argv[++i];
         } else if (arg == "--pbarg" && i + 1 < argc) {
             pbArguments = argv[++i];
+        } else if (arg == "--cuts" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "off") cutMode = CutMode::OFF;
+            else if (mode == "root") cutMode = CutMode::ROOT;
+            else if (mode == "node") cutMode = CutMode::NODE;
+            else {
+                std::cerr << "Unknown cut mode: " << mode << "\n";
+                return 1;
+            }
+        } else if (arg == "--pricing" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "auto") pricingMode = PricingMode::AUTO;
+            else if (mode == "exhaustive") pricingMode = PricingMode::EXHAUSTIVE;
+            else if (mode == "patterns") pricingMode = PricingMode::PATTERNS;
+            else {
+                std::cerr << "Unknown pricing mode: " << mode << "\n";
+                return 1;
+            }
+        } else if (arg == "--column-age" && i + 1 < argc) {
+            columnAge = std::stoi(argv[++i]);
+        } else if (arg == "--dump" && i + 1 < argc) {
+            dumpDir = argv[++i];
+        } else if (arg == "--dump-limit" && i + 1 < argc) {
+            dumpLimit = std::stoi(argv[++i]);
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayFile = argv[++i];
+        } else if (arg == "--convert" && i + 1 < argc) {
+            convertFile = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchSource = argv[++i];
+        } else if (arg == "--serve") {
+            serve = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            serve = true;
+            socketPath = argv[++i];
+        } else if (arg == "--generate" && i + 1 < argc) {
+            generateSpec = argv[++i];
+        } else if (arg == "--regress" && i + 1 < argc) {
+            regressGrid = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            regress.baseline = argv[++i];
+        } else if (arg == "--update-baseline") {
+            regress.updateBaseline = true;
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            regress.threshold = std::stod(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            batch.threads = static_cast<unsigned>(std::stoi(argv[++i]));
+        } else if (arg == "--format" && i + 1 < argc) {
+            batch.format = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            batch.output = argv[++i];
+        } else if ((arg == "--timeout" || arg == "--time-limit") && i + 1 < argc) {
+            timeLimit = std::stod(argv[++i]);
+        } else if (arg == "--node-limit" && i + 1 < argc) {
+            nodeLimit = std::stol(argv[++i]);
+        } else if (arg == "--mem-limit" && i + 1 < argc) {
+            memLimit = std::stod(argv[++i]);
+        } else if (arg == "--progress" && i + 1 < argc) {
+            progressInterval = std::stod(argv[++i]);
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpointFile = argv[++i];
+        } else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+            checkpointInterval = std::stod(argv[++i]);
+        } else if (arg == "--resume" && i + 1 < argc) {
+            resumeFile = argv[++i];
+        } else if (arg == "--column-cache" && i + 1 < argc) {
+            columnCache = argv[++i];
+        } else if (arg == "--stats" && i + 1 < argc) {
+            statsFormat = argv[++i];
+            if (statsFormat != "json") {
+                std::cerr << "Unknown stats format: " << statsFormat << "\n";
+                return 1;
+            }
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile.name = argv[++i];
+        } else if (arg == "--no-decompose") {
+            decompose = false;
+        } else if (arg == "--no-normalize") {
+            normalize = false;
+        } else if (arg == "--no-presolve") {
+            presolve = false;
+        } else if (arg == "--presolve-relations") {
+            presolveRelations = true;
+        } else if (arg == "--no-symmetry") {
+            symmetry = false;
+        } else if (arg == "--fast") {
+            fast = true;
         } else if (arg == "--verbose") {
             verbose = true;
         } else if (arg == "--help") {
@@ -31,6 +234,47 @@ int main(int argc, char* argv[]) {
             std::cout << "  --no-pb           Disables use of PB-SAT (uses only exhaustive search)\n";
             std::cout << "  --pbsolver <path> Path to PB-SAT solver (e.g. minisat+)\n";
             std::cout << "  --pbarg <arg>     Arguments to PB-SAT solver (e.g. -formula=1)\n";
+            std::cout << "  --no-normalize    Disables AC-canonicalization and simplification of the formulas\n";
+            std::cout << "  --no-presolve     Disables the classical relations between P atoms in the root LP\n";
+            std::cout << "  --presolve-relations  Adds implications, exclusions and covers between P atoms when violated\n";
+            std::cout << "  --no-symmetry     Disables symmetry breaking over interchangeable variables\n";
+            std::cout << "  --no-decompose    Solves independent groups of formulas as a single problem\n";
+            std::cout << "  --cuts <mode>     Gadget facet cuts: off, root (default) or node\n";
+            std::cout << "  --pricing <mode>  Pricing without PB-SAT: exhaustive, patterns (of the P atoms) or\n";
+            std::cout << "                    auto (default: patterns with fewer P atoms than variables or above 20 variables)\n";
+            std::cout << "  --column-age <n>  Iterations out of the basis before a column is pooled (0 disables)\n";
+            std::cout << "  --fast            Loose tolerances, final verdict certified in exact arithmetic\n";
+            std::cout << "  --dump <dir>      Writes node LPs (LP/MPS) and pricing problems (OPB) to <dir>\n";
+            std::cout << "  --dump-limit <n>  Maximum number of nodes and pricing problems dumped (default 16)\n";
+            std::cout << "  --replay <file>   Solves a dumped .lp/.mps/.opb file and reports the time\n";
+            std::cout << "  --timeout <s>     Time limit per instance in seconds (verdict UNKNOWN, exit code 3)\n";
+            std::cout << "  --time-limit <s>  Same as --timeout\n";
+            std::cout << "  --node-limit <n>  Maximum number of branch node LPs, summed over independent groups\n";
+            std::cout << "                    (verdict UNKNOWN, exit code 3)\n";
+            std::cout << "  --mem-limit <MB>  Resident memory limit of the whole process, shared by independent groups;\n";
+            std::cout << "                    depth-first search from 80% of it (verdict UNKNOWN)\n";
+            std::cout << "  --progress <s>    Seconds between progress lines (default 10, 0 disables)\n";
+            std::cout << "  --checkpoint <file> Saves the search state to <file> periodically, when a limit is\n";
+            std::cout << "                    reached and on SIGINT/SIGTERM\n";
+            std::cout << "  --checkpoint-interval <s> Seconds between checkpoints (default 300)\n";
+            std::cout << "  --resume <file>   Continues the search saved in a checkpoint of the same instance\n";
+            std::cout << "  --column-cache <dir> Reuses the columns of earlier runs with the same P atoms\n";
+            std::cout << "  --batch <list|dir> Solves every instance listed in a file (one path per line) or\n";
+            std::cout << "                    found in a directory (.fpl, .txt, .fplb) in a single process\n";
+            std::cout << "  --serve           Answers requests read from stdin (see README) until EOF\n";
+            std::cout << "  --socket <path>   Serves requests on a Unix domain socket instead of stdin\n";
+            std::cout << "  --threads <n>     Instances solved in parallel in batch and serve modes (default: all cores)\n";
+            std::cout << "  --format <fmt>    Batch result lines: csv (default) or jsonl\n";
+            std::cout << "  --output <file>   Writes batch results to <file> instead of stdout\n";
+            std::cout << "  --convert <file>  Writes the input instance in binary format to <file> and exits\n";
+            std::cout << "  --generate <spec> Writes a seeded instance (e.g. np-classical:n=20,m=40,l1=3,l2=3,seed=1)\n";
+            std::cout << "                    to stdout, or to --output <file>\n";
+            std::cout << "  --regress <grid>  Solves the generated instances of a grid and compares them with --baseline\n";
+            std::cout << "  --baseline <file> Regression baseline (recorded on the first run)\n";
+            std::cout << "  --update-baseline Records the current measures as the new baseline\n";
+            std::cout << "  --threshold <x>   Tolerated relative slowdown in --regress (default 0.25)\n";
+            std::cout << "  --stats json      Writes solver counters and per-phase timers to stderr at exit\n";
+            std::cout << "  --trace <file>    Writes a timeline of the solve in Chrome trace-event format\n";
             std::cout << "  --verbose         Verbose mode\n";
             std::cout << "  --help            Display this help\n";
             return 0;
@@ -40,17 +284,160 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (!replayFile.empty()) {
+        try {
+            return replay(replayFile, pbsolverPath, pbArguments);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!traceFile.name.empty())
+        trace::start();
+
+    FPOptions solverOptions;
+    solverOptions.usePB = usePB;
+    solverOptions.pbSolver = pbsolverPath;
+    solverOptions.pbArguments = pbArguments;
+    solverOptions.normalize = normalize;
+    solverOptions.presolve = presolve;
+    solverOptions.presolveRelations = presolveRelations;
+    solverOptions.symmetry = symmetry;
+    solverOptions.cuts = cutMode;
+    solverOptions.pricing = pricingMode;
+    solverOptions.fast = fast;
+    solverOptions.columnAge = columnAge;
+    solverOptions.timeLimit = timeLimit;
+    solverOptions.nodeLimit = nodeLimit;
+    solverOptions.memLimitMB = memLimit;
+    solverOptions.columnCache = columnCache;
+    solverOptions.decompose = decompose;
+
+    if (!generateSpec.empty()) {
+        try {
+            std::string formula = generateInstance(parseGeneratorSpec(generateSpec));
+            if (batch.output.empty()) {
+                std::cout << formula << "\n";
+            } else {
+                std::ofstream out(batch.output);
+                if (!out)
+                    throw std::runtime_error("Could not open file: " + batch.output);
+                out << formula << "\n";
+            }
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!regressGrid.empty()) {
+        try {
+            if (regress.baseline.empty())
+                throw std::runtime_error("--regress requires --baseline <file>");
+            regress.solver = solverOptions;
+            return runRegress(regressGrid, regress) == 0 ? 0 : 4;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (serve) {
+        try {
+            ServeOptions options;
+            options.solver = solverOptions;
+            options.threads = batch.threads;
+            options.socket = socketPath;
+            runServer(options);
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!batchSource.empty()) {
+        try {
+            batch.solver = solverOptions;
+            runBatch(listBatchInstances(batchSource), batch);
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     if (inputFile.empty()) {
         std::cerr << "Error: Input file not provided. Use -i <file>\n";
         return 1;
     }
 
     try {
-        std::vector<ModalFormula> formulas = loadModalFormulasFromFile(inputFile);
+        FormulaStore store;
+        LoadStats load;
+        std::vector<FormulaId> formulas;
+        {
+            TraceSpan span("load");
+            formulas = loadModalFormulasFromFile(inputFile, store, &load);
+        }
+        if (verbose)
+            std::cout << "[Load] " << load.formulas << " formulas, " << load.bytes / 1e6 << " MB in "
+                      << load.seconds << " s (" << load.throughput() << " MB/s, "
+                      << load.threads << (load.threads == 1 ? " thread)" : " threads)") << std::endl;
+
+        if (!convertFile.empty()) {
+            writeBinaryInstance(convertFile, store, formulas);
+            std::cout << "[Convert] " << formulas.size() << " formulas, " << store.size() << " nodes, "
+                      << store.numVars() << " variables -> " << convertFile << " ("
+                      << std::filesystem::file_size(convertFile) / 1e6 << " MB)" << std::endl;
+            return 0;
+        }
 
-        FPSolver solver(std::move(formulas), inputFile, verbose);
+        FPSolver solver(std::move(store), std::move(formulas), verbose);
+        solver.setLog(&std::cout);
         solver.setPBOptions(usePB, pbsolverPath, pbArguments);
+        solver.setNormalize(normalize);
+        solver.setPresolve(presolve, presolveRelations);
+        solver.setSymmetry(symmetry);
+        solver.setCutMode(cutMode);
+        solver.setPricingMode(pricingMode);
+        solver.setFastMode(fast);
+        solver.setColumnAging(columnAge);
+        solver.setDumpOptions(dumpDir, dumpLimit);
+        solver.setResourceLimits(nodeLimit, memLimit);
+        solver.setProgressInterval(progressInterval);
+        solver.setColumnCache(columnCache);
+        solver.setDecompose(decompose);
+        if (!checkpointFile.empty()) {
+            solver.setCheckpoint(checkpointFile, checkpointInterval);
+            std::signal(SIGINT, requestStop);
+            std::signal(SIGTERM, requestStop);
+            solver.setLimits(timeLimit, &stopRequested);
+        } else {
+            solver.setLimits(timeLimit);
+        }
+        if (!resumeFile.empty())
+            solver.setResume(resumeFile);
         bool sat = solver.solve();
+
+        FPResult result = solver.result();
+        result.stats.parseSeconds = load.seconds;
+        if (!statsFormat.empty())
+            std::cerr << fplStatsJson(result) << std::endl;
+
+        if (verbose) std::cout << std::endl;
+        if (result.status == FPStatus::UNKNOWN) {
+            std::cout << "UNKNOWN (" << result.reason << ")" << std::endl;
+            return 3;
+        }
+        std::cout << (sat ? "SAT (" : "UNSAT (") << result.reason << ")" << std::endl;
+        if (sat) {
+            std::cout << "\n";
+            printSolution(std::cout, result);
+            saveOutputToFile(inputFile, result);
+        }
         return sat ? 0 : 2;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
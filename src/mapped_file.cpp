@@ -0,0 +1,33 @@
+#include "mapped_file.h"
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Could not open file: " + filename);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Could not map file: " + filename);
+        }
+        data = static_cast<const char*>(addr);
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data) ::munmap(const_cast<char*>(data), size);
+}
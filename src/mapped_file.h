@@ -0,0 +1,24 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Arquivo mapeado em memória, somente leitura
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view text() const { return {data, size}; }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,206 @@
+#include "normalize.h"
+#include <algorithm>
+
+using M = ModalConnective;
+using C = CPLConnective;
+
+Normalizer::Normalizer(FormulaStore& store_) : store(store_) {}
+
+// ----------- Normalização das raízes -----------
+
+bool Normalizer::normalize(std::vector<FormulaId>& formulas, NormalizeStats& stats) {
+    count(formulas, stats.xBefore, stats.bBefore);
+
+    std::vector<FormulaId> order = store.reachable(formulas);
+
+    // Nós internos de uma cadeia AC (só usados por pais com o mesmo
+    // conectivo) não são normalizados sozinhos: a raiz da cadeia a percorre
+    // inteira uma única vez, o que mantém cadeias longas em tempo linear
+    chainRoot.assign(store.size(), false);
+    for (FormulaId f : formulas)
+        chainRoot[f] = true;
+    for (FormulaId id : order) {
+        const FormulaNode& n = store[id];
+        for (FormulaId c : {n.left, n.right})
+            if (c != NO_FORMULA && (!isAC(n) || store[c].modal != n.modal || store[c].op != n.op))
+                chainRoot[c] = true;
+    }
+
+    // Os filhos têm ID menor: em ordem crescente eles já estão normalizados
+    memo.assign(store.size(), NO_FORMULA);
+    for (FormulaId id : order) {
+        if (!chainRoot[id])
+            continue;
+        if (!store[id].modal && store[id].cplOp() == C::VAR)
+            memo[id] = id;
+        else
+            memo[id] = simplify(id);
+    }
+
+    bool satisfiable = true;
+    std::vector<FormulaId> result;
+    for (FormulaId f : formulas) {
+        FormulaId g = memo[f];
+        if (g == TRUE_FORMULA)
+            continue;
+        if (g == FALSE_FORMULA) {
+            satisfiable = false;
+            continue;
+        }
+        if (std::find(result.begin(), result.end(), g) == result.end())
+            result.push_back(g);
+    }
+    formulas = std::move(result);
+
+    count(formulas, stats.xAfter, stats.bAfter);
+    return satisfiable;
+}
+
+void Normalizer::count(const std::vector<FormulaId>& formulas, int& xVars, int& bVars) const {
+    xVars = bVars = 0;
+    for (FormulaId id : store.reachable(formulas)) {
+        if (!store[id].modal) continue;
+        ++xVars;
+        if (store[id].modalOp() != M::P_ATOM && store[id].modalOp() != M::NOT)
+            ++bVars;
+    }
+}
+
+// ----------- Regras -----------
+
+FormulaId Normalizer::make(bool modal, std::uint8_t op, FormulaId lhs, FormulaId rhs) {
+    return modal ? store.modal(static_cast<M>(op), lhs, rhs)
+                 : store.cpl(static_cast<C>(op), lhs, rhs);
+}
+
+bool Normalizer::isNegationOf(FormulaId a, FormulaId b) const {
+    const FormulaNode& n = store[a];
+    bool isNot = n.modal ? n.modalOp() == M::NOT : n.cplOp() == C::NOT;
+    return isNot && n.left == b;
+}
+
+bool Normalizer::isAC(const FormulaNode& n) {
+    if (n.modal)
+        return n.modalOp() == M::AND || n.modalOp() == M::OR || n.modalOp() == M::OPLUS || n.modalOp() == M::ODOT;
+    return n.cplOp() == C::AND || n.cplOp() == C::OR;
+}
+
+FormulaId Normalizer::simplify(FormulaId id) {
+    if (isAC(store[id]))
+        return simplifyAC(id);
+
+    // Cópia: 'make' pode realocar a arena e invalidar referências aos nós
+    const FormulaNode& node = store[id];
+    bool modal = node.modal;
+    std::uint8_t op = node.op;
+    FormulaId l = memo[node.left];
+    FormulaId r = node.right != NO_FORMULA ? memo[node.right] : NO_FORMULA;
+
+    if (modal && op == static_cast<std::uint8_t>(M::P_ATOM)) {
+        if (l == TRUE_FORMULA || l == FALSE_FORMULA)
+            return l;
+        return store.patom(l);
+    }
+
+    bool isNot = modal ? op == static_cast<std::uint8_t>(M::NOT) : op == static_cast<std::uint8_t>(C::NOT);
+    bool isImplies = modal ? op == static_cast<std::uint8_t>(M::IMPLIES) : op == static_cast<std::uint8_t>(C::IMPLIES);
+    bool isIff = modal ? op == static_cast<std::uint8_t>(M::IFF) : op == static_cast<std::uint8_t>(C::IFF);
+
+    if (isNot)
+        return simplifyNot(modal, l);
+
+    if (isImplies) {
+        if (l == TRUE_FORMULA) return r;
+        if (l == FALSE_FORMULA || r == TRUE_FORMULA || l == r) return TRUE_FORMULA;
+        if (r == FALSE_FORMULA) return simplifyNot(modal, l);
+        return make(modal, op, l, r);
+    }
+
+    if (isIff) {
+        if (l == TRUE_FORMULA) return r;
+        if (r == TRUE_FORMULA) return l;
+        if (l == FALSE_FORMULA) return simplifyNot(modal, r);
+        if (r == FALSE_FORMULA) return simplifyNot(modal, l);
+        if (l == r) return TRUE_FORMULA;
+        // Clássico: φ ↔ ¬φ é ⊥; em Ł vale 1 - |2x - 1|
+        if (!modal && (isNegationOf(l, r) || isNegationOf(r, l))) return FALSE_FORMULA;
+        return make(modal, op, std::min(l, r), std::max(l, r));
+    }
+
+    return make(modal, op, l, r);
+}
+
+FormulaId Normalizer::simplifyNot(bool modal, FormulaId operand) {
+    if (operand == TRUE_FORMULA) return FALSE_FORMULA;
+    if (operand == FALSE_FORMULA) return TRUE_FORMULA;
+
+    const FormulaNode& n = store[operand];
+    bool isNot = modal ? n.modalOp() == M::NOT : n.cplOp() == C::NOT;
+    if (n.modal == modal && isNot)
+        return n.left;
+
+    return make(modal, modal ? static_cast<std::uint8_t>(M::NOT) : static_cast<std::uint8_t>(C::NOT), operand);
+}
+
+FormulaId Normalizer::simplifyAC(FormulaId id) {
+    bool modal = store[id].modal;
+    std::uint8_t op = store[id].op;
+
+    // ∧ e ⊙ têm ⊤ como neutro e ⊥ como absorvente; ∨ e ⊕, o contrário
+    bool conjunctive = modal ? (op == static_cast<std::uint8_t>(M::AND) || op == static_cast<std::uint8_t>(M::ODOT))
+                             : op == static_cast<std::uint8_t>(C::AND);
+    bool idempotent = modal ? (op == static_cast<std::uint8_t>(M::AND) || op == static_cast<std::uint8_t>(M::OR))
+                            : true;
+    // φ com ¬φ: vale para ∧/∨ clássicos e para ⊙/⊕, não para min/max em Ł
+    bool complementary = !modal || !idempotent;
+
+    FormulaId identity = conjunctive ? TRUE_FORMULA : FALSE_FORMULA;
+    FormulaId absorbing = conjunctive ? FALSE_FORMULA : TRUE_FORMULA;
+
+    // Operandos da cadeia original: desce pelos nós internos com o mesmo
+    // conectivo; os demais já estão normalizados
+    std::vector<FormulaId> operands;
+    std::vector<FormulaId> pending{store[id].left, store[id].right};
+    while (!pending.empty()) {
+        FormulaId c = pending.back();
+        pending.pop_back();
+
+        if (!chainRoot[c]) {
+            pending.push_back(store[c].left);
+            pending.push_back(store[c].right);
+            continue;
+        }
+
+        c = memo[c];
+        if (c == identity) continue;
+        if (c == absorbing) return absorbing;
+
+        // Operando normalizado com o mesmo conectivo: cadeia aninhada à esquerda
+        while (store[c].modal == modal && store[c].op == op) {
+            operands.push_back(store[c].right);
+            c = store[c].left;
+        }
+        operands.push_back(c);
+    }
+
+    std::sort(operands.begin(), operands.end());
+    if (idempotent)
+        operands.erase(std::unique(operands.begin(), operands.end()), operands.end());
+
+    if (complementary) {
+        for (FormulaId o : operands) {
+            const FormulaNode& n = store[o];
+            if (n.modal == modal && isNegationOf(o, n.left) &&
+                std::binary_search(operands.begin(), operands.end(), n.left))
+                return absorbing;
+        }
+    }
+
+    if (operands.empty())
+        return identity;
+
+    FormulaId result = operands[0];
+    for (size_t k = 1; k < operands.size(); ++k)
+        result = make(modal, op, result, operands[k]);
+    return result;
+}
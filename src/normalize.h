@@ -0,0 +1,51 @@
+#ifndef NORMALIZE_HPP
+#define NORMALIZE_HPP
+
+#include "formula.h"
+#include <vector>
+
+// Constantes ⊤/⊥ que só existem durante a normalização: nenhuma subfórmula
+// normalizada as contém, pois toda regra que as recebe as elimina
+constexpr FormulaId TRUE_FORMULA = -2;
+constexpr FormulaId FALSE_FORMULA = -3;
+
+// Colunas x(·) e binárias b(·) do PL antes e depois da normalização
+struct NormalizeStats {
+    int xBefore = 0, xAfter = 0;
+    int bBefore = 0, bAfter = 0;
+};
+
+// Forma canônica das fórmulas no armazém, antes da codificação:
+//   - cadeias de operadores associativos e comutativos (∧, ∨ nos dois níveis;
+//     ⊕, ⊙ em FP(Ł)) são achatadas e reconstruídas com os operandos em ordem
+//     de ID, à esquerda; ↔ tem os dois lados ordenados;
+//   - ¬¬φ = φ; operandos repetidos saem de ∧/∨ (idempotentes), mas não de ⊕/⊙;
+//   - φ e ¬φ juntos: ∨ clássico e ⊕ viram ⊤, ∧ clássico e ⊙ viram ⊥;
+//     φ → φ e φ ↔ φ viram ⊤;
+//   - ⊤/⊥ são propagados, e Pψ com ψ ⊤ (⊥) vira ⊤ (⊥).
+// Como o armazém faz hash-consing, fórmulas equivalentes por essas regras
+// passam a compartilhar o mesmo ID e, portanto, as mesmas variáveis do PL.
+class Normalizer {
+public:
+    explicit Normalizer(FormulaStore& store);
+
+    // Normaliza 'formulas'; as que viram ⊤ são removidas. Retorna false se
+    // alguma vira ⊥ (instância insatisfazível).
+    bool normalize(std::vector<FormulaId>& formulas, NormalizeStats& stats);
+
+private:
+    FormulaStore& store;
+    std::vector<FormulaId> memo;    // ID original -> ID normalizado
+    std::vector<bool> chainRoot;    // normalizado por si (não é interno a uma cadeia AC)
+
+    static bool isAC(const FormulaNode& f);
+    FormulaId simplify(FormulaId id);
+    FormulaId simplifyNot(bool modal, FormulaId operand);
+    FormulaId simplifyAC(FormulaId id);
+    FormulaId make(bool modal, std::uint8_t op, FormulaId lhs, FormulaId rhs = NO_FORMULA);
+    bool isNegationOf(FormulaId a, FormulaId b) const;
+
+    void count(const std::vector<FormulaId>& formulas, int& xVars, int& bVars) const;
+};
+
+#endif // NORMALIZE_HPP
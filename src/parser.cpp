@@ -1,249 +1,319 @@
 #include "parser.h"
+#include "binary_format.h"
+#include "mapped_file.h"
 #include <stdexcept>
 #include <fstream>
 #include <sstream>
-#include <cctype>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <thread>
 
-// ---------- Utilitários ----------
-char CPLParser::peek() const {
-    return pos < input.size() ? input[pos] : '\0';
-}
+// ---------- Analisador léxico ----------
 
-char CPLParser::get() {
-    return pos < input.size() ? input[pos++] : '\0';
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
 }
 
-void CPLParser::skipWhitespace() {
-    while (std::isspace(peek())) pos++;
+static bool isIdentStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
 }
 
-bool CPLParser::match(const std::string& expected) {
-    skipWhitespace();
-    if (input.substr(pos, expected.size()) == expected) {
-        pos += expected.size();
-        return true;
-    }
-    return false;
+static bool isIdentChar(char c) {
+    return isIdentStart(c) || (c >= '0' && c <= '9');
 }
 
-// ---------- Parser de CPL ----------
+// Conectivos em UTF-8
+static constexpr std::pair<std::string_view, TokenKind> SYMBOLS[] = {
+    {"¬", TokenKind::NOT},
+    {"∧", TokenKind::AND},
+    {"∨", TokenKind::OR},
+    {"→", TokenKind::IMPLIES},
+    {"↔", TokenKind::IFF},
+    {"⊕", TokenKind::OPLUS},
+    {"⊙", TokenKind::ODOT},
+};
+
+Token Lexer::next(bool cpl) {
+    while (pos < input.size() && isSpace(input[pos]))
+        ++pos;
+
+    if (pos >= input.size())
+        return {TokenKind::END, {}};
+
+    size_t start = pos;
+    char c = input[pos];
+
+    if (c == '(') { ++pos; return {TokenKind::LPAREN, input.substr(start, 1)}; }
+    if (c == ')') { ++pos; return {TokenKind::RPAREN, input.substr(start, 1)}; }
+
+    if (!cpl && c == 'P') {
+        ++pos;
+        return {TokenKind::P, input.substr(start, 1)};
+    }
 
-CPLParser::CPLParser(const std::string& input_) : input(input_), pos(0) {}
+    if (cpl && isIdentStart(c)) {
+        while (pos < input.size() && isIdentChar(input[pos]))
+            ++pos;
+        return {TokenKind::VAR, input.substr(start, pos - start)};
+    }
 
-CPLFormula CPLParser::parse() {
-    skipWhitespace();
-    CPLFormula result = parseFormula();
-    skipWhitespace();
-    if (pos != input.size()) throw std::runtime_error("Extra entry after CPL formula.");
-    return result;
-}
+    for (const auto& [symbol, kind] : SYMBOLS) {
+        if (input.compare(pos, symbol.size(), symbol) == 0) {
+            pos += symbol.size();
+            return {kind, input.substr(start, symbol.size())};
+        }
+    }
 
-CPLFormula CPLParser::parseFormula() {
-    return parseBinary(0);
+    return {TokenKind::INVALID, input.substr(start, 1)};
 }
 
 // ---------- Precedência dos conectivos ----------
-int precedence(CPLConnective op) {
-    switch (op) {
-        case CPLConnective::IFF:     return 1;
-        case CPLConnective::IMPLIES: return 2;
-        case CPLConnective::OR:      return 3;
-        case CPLConnective::AND:     return 4;
-        case CPLConnective::NOT:     return 5;
-        default: return 0;
-    }
-}
 
-// ---------- Parser de expressões ----------
-CPLFormula CPLParser::parseBinary(int minPrec) {
-    CPLFormula left = parseUnary();
-    while (true) {
-        skipWhitespace();
-        CPLConnective op;
-        if (match("∧")) op = CPLConnective::AND;
-        else if (match("∨")) op = CPLConnective::OR;
-        else if (match("→")) op = CPLConnective::IMPLIES;
-        else if (match("↔")) op = CPLConnective::IFF;
-        else break;
-
-        int prec = precedence(op);
-        if (prec < minPrec) break;
-
-        CPLFormula right = parseBinary(prec + 1);
-        left = CPLFormula::binary(op, std::move(left), std::move(right));
+static bool isBinary(TokenKind kind) {
+    switch (kind) {
+        case TokenKind::AND: case TokenKind::OR: case TokenKind::IMPLIES:
+        case TokenKind::IFF: case TokenKind::OPLUS: case TokenKind::ODOT:
+            return true;
+        default:
+            return false;
     }
-    return left;
 }
 
-CPLFormula CPLParser::parseUnary() {
-    skipWhitespace();
-    if (match("¬")) {
-        return CPLFormula::unary(CPLConnective::NOT, parseUnary());
-    } else {
-        return parsePrimary();
+static int precedence(TokenKind kind) {
+    switch (kind) {
+        case TokenKind::IFF:     return 1;
+        case TokenKind::IMPLIES: return 2;
+        case TokenKind::OR:      return 3;
+        case TokenKind::AND:     return 4;
+        case TokenKind::ODOT:    return 5;
+        case TokenKind::OPLUS:   return 6;
+        default: return 0;
     }
 }
 
-CPLFormula CPLParser::parsePrimary() {
-    skipWhitespace();
-    if (match("(")) {
-        CPLFormula f = parseFormula();
-        if (!match(")")) throw std::runtime_error("Right parenthesis expected.");
-        return f;
+static std::uint8_t connective(TokenKind kind, bool modal) {
+    if (modal) {
+        switch (kind) {
+            case TokenKind::AND:     return static_cast<std::uint8_t>(ModalConnective::AND);
+            case TokenKind::OR:      return static_cast<std::uint8_t>(ModalConnective::OR);
+            case TokenKind::IMPLIES: return static_cast<std::uint8_t>(ModalConnective::IMPLIES);
+            case TokenKind::IFF:     return static_cast<std::uint8_t>(ModalConnective::IFF);
+            case TokenKind::OPLUS:   return static_cast<std::uint8_t>(ModalConnective::OPLUS);
+            default:                 return static_cast<std::uint8_t>(ModalConnective::ODOT);
+        }
     }
-
-    if (std::isalpha(peek()) || peek() == '_') {
-        std::string name;
-        while (std::isalnum(peek()) || peek() == '_')
-            name += get();
-        return CPLFormula::variable(name);
+    switch (kind) {
+        case TokenKind::AND:     return static_cast<std::uint8_t>(CPLConnective::AND);
+        case TokenKind::OR:      return static_cast<std::uint8_t>(CPLConnective::OR);
+        case TokenKind::IMPLIES: return static_cast<std::uint8_t>(CPLConnective::IMPLIES);
+        default:                 return static_cast<std::uint8_t>(CPLConnective::IFF);
     }
-
-    throw std::runtime_error("Unexpected symbol in CPL formula.");
 }
 
-// ---------- ModalParser utilitários ----------
+// ---------- Parser ----------
 
-char ModalParser::peek() const {
-    return pos < input.size() ? input[pos] : '\0';
-}
+FormulaParser::FormulaParser(std::string_view input, FormulaStore& store_, bool cpl)
+    : lexer(input), store(store_), cplOnly(cpl) {}
 
-char ModalParser::get() {
-    return pos < input.size() ? input[pos++] : '\0';
-}
+void FormulaParser::reduce() {
+    Op op = ops.back();
+    ops.pop_back();
+
+    FormulaId right = operands.back();
+    operands.pop_back();
+    FormulaId left = operands.back();
 
-void ModalParser::skipWhitespace() {
-    while (std::isspace(peek())) pos++;
+    operands.back() = op.modal ? store.modal(static_cast<ModalConnective>(op.op), left, right)
+                               : store.cpl(static_cast<CPLConnective>(op.op), left, right);
 }
 
-bool ModalParser::match(const std::string& expected) {
-    skipWhitespace();
-    if (input.substr(pos, expected.size()) == expected) {
-        pos += expected.size();
-        return true;
+void FormulaParser::pushOperand(FormulaId f) {
+    // Um operando completo fecha as negações pendentes sobre ele
+    while (!ops.empty() && ops.back().frame == Frame::NOT) {
+        f = ops.back().modal ? store.modal(ModalConnective::NOT, f) : store.cpl(CPLConnective::NOT, f);
+        ops.pop_back();
     }
-    return false;
+    operands.push_back(f);
 }
 
-// ---------- Construtor ----------
+FormulaId FormulaParser::parse() {
+    operands.clear();
+    ops.clear();
 
-ModalParser::ModalParser(const std::string& input_) : input(input_), pos(0) {}
+    bool cpl = cplOnly;          // nível corrente: dentro de P(...) é CPL
+    bool expectOperand = true;
 
-ModalFormula ModalParser::parse() {
-    skipWhitespace();
-    ModalFormula result = parseFormula();
-    skipWhitespace();
-    if (pos != input.size()) throw std::runtime_error("Extra entry after modal formula.");
-    return result;
-}
+    while (true) {
+        Token t = lexer.next(cpl);
+
+        if (expectOperand) {
+            switch (t.kind) {
+                case TokenKind::NOT:
+                    ops.push_back({Frame::NOT, !cpl, 0, 0});
+                    break;
+                case TokenKind::LPAREN:
+                    ops.push_back({Frame::LPAREN, !cpl, 0, 0});
+                    break;
+                case TokenKind::P:
+                    if (lexer.next(true).kind != TokenKind::LPAREN)
+                        throw std::runtime_error("Expected '(' after P.");
+                    ops.push_back({Frame::PATOM, true, 0, 0});
+                    cpl = true;
+                    break;
+                case TokenKind::VAR:
+                    pushOperand(store.variable(t.text));
+                    expectOperand = false;
+                    break;
+                default:
+                    throw std::runtime_error("Unexpected symbol in CPL formula.");
+            }
+            continue;
+        }
 
-// ---------- Precedência dos conectivos Ł ----------
-
-int modalPrecedence(ModalConnective op) {
-    switch (op) {
-        case ModalConnective::IFF:     return 1;
-        case ModalConnective::IMPLIES: return 2;
-        case ModalConnective::OR:      return 3;
-        case ModalConnective::AND:     return 4;
-        case ModalConnective::ODOT:    return 5;
-        case ModalConnective::OPLUS:   return 6;
-        case ModalConnective::NOT:     return 7;
-        default: return 0;
-    }
-}
+        if (isBinary(t.kind)) {
+            if (cpl && (t.kind == TokenKind::OPLUS || t.kind == TokenKind::ODOT))
+                throw std::runtime_error("Extra entry after CPL formula.");
+
+            // Associatividade à esquerda: reduz os de precedência maior ou igual
+            int prec = precedence(t.kind);
+            while (!ops.empty() && ops.back().frame == Frame::BINARY && ops.back().precedence >= prec)
+                reduce();
+            ops.push_back({Frame::BINARY, !cpl, connective(t.kind, !cpl), prec});
+            expectOperand = true;
+            continue;
+        }
 
-// ---------- Parser principal ----------
+        if (t.kind == TokenKind::RPAREN) {
+            while (!ops.empty() && ops.back().frame == Frame::BINARY)
+                reduce();
+            if (ops.empty())
+                throw std::runtime_error(cpl ? "Extra entry after CPL formula." : "Extra entry after modal formula.");
+
+            Frame frame = ops.back().frame;
+            ops.pop_back();
+            FormulaId f = operands.back();
+            operands.pop_back();
+
+            if (frame == Frame::PATOM) {
+                f = store.patom(f);
+                cpl = false;
+            }
+            pushOperand(f);
+            continue;
+        }
 
-ModalFormula ModalParser::parseFormula() {
-    return parseBinary(0);
-}
+        if (t.kind == TokenKind::END) {
+            while (!ops.empty() && ops.back().frame == Frame::BINARY)
+                reduce();
+            if (!ops.empty())
+                throw std::runtime_error("Right parenthesis expected.");
+            return operands.back();
+        }
 
-ModalFormula ModalParser::parseBinary(int minPrec) {
-    ModalFormula left = parseUnary();
-    while (true) {
-        skipWhitespace();
-        ModalConnective op;
-
-        if (match("↔")) op = ModalConnective::IFF;
-        else if (match("→")) op = ModalConnective::IMPLIES;
-        else if (match("∨")) op = ModalConnective::OR;
-        else if (match("∧")) op = ModalConnective::AND;
-        else if (match("⊙")) op = ModalConnective::ODOT;
-        else if (match("⊕")) op = ModalConnective::OPLUS;
-        else break;
-
-        int prec = modalPrecedence(op);
-        if (prec < minPrec) break;
-
-        ModalFormula right = parseBinary(prec + 1);
-        left = ModalFormula::binary(op, std::move(left), std::move(right));
+        throw std::runtime_error(cpl ? "Extra entry after CPL formula." : "Extra entry after modal formula.");
     }
-    return left;
 }
 
-ModalFormula ModalParser::parseUnary() {
-    skipWhitespace();
-    if (match("¬")) {
-        return ModalFormula::unary(ModalConnective::NOT, parseUnary());
-    } else {
-        return parsePrimary();
+// ---------- Carregar fórmulas modais de um arquivo ----------
+
+namespace {
+
+// Linha não vazia do arquivo e seu número (para mensagens de erro)
+struct Line {
+    std::string_view text;
+    size_t number;
+};
+
+void parseLines(const std::vector<Line>& lines, size_t begin, size_t end,
+                FormulaStore& store, std::vector<FormulaId>& out) {
+    for (size_t k = begin; k < end; ++k) {
+        try {
+            ModalParser parser(lines[k].text, store);
+            out.push_back(parser.parse());
+        } catch (const std::exception& e) {
+            throw std::runtime_error("Line " + std::to_string(lines[k].number) + ": " + e.what());
+        }
     }
 }
 
-ModalFormula ModalParser::parsePrimary() {
-    skipWhitespace();
-
-    if (match("(")) {
-        ModalFormula f = parseFormula();
-        if (!match(")")) throw std::runtime_error("Right parenthesis expected.");
-        return f;
+// Arquivo de texto: uma fórmula modal por linha
+std::vector<FormulaId> parseText(std::string_view text, FormulaStore& store, unsigned& threads) {
+    std::vector<Line> lines;
+    size_t number = 1;
+    for (size_t pos = 0; pos < text.size(); ++number) {
+        size_t nl = text.find('\n', pos);
+        if (nl == std::string_view::npos) nl = text.size();
+        if (nl > pos)
+            lines.push_back({text.substr(pos, nl - pos), number});
+        pos = nl + 1;
     }
 
-    if (match("P")) {
-        if (!match("(")) throw std::runtime_error("Expected '(' after P.");
-        CPLFormula inner = parseCPLInsideP();
-        return ModalFormula::patom(std::move(inner));
-    }
+    // Cada thread analisa um bloco contíguo de linhas num armazém próprio;
+    // os armazéns são fundidos na ordem dos blocos, preservando a das fórmulas
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    if (text.size() < (1u << 20))
+        threads = 1;
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, lines.size())));
+
+    std::vector<FormulaId> formulas;
+    if (threads == 1) {
+        parseLines(lines, 0, lines.size(), store, formulas);
+    } else {
+        std::vector<FormulaStore> local(threads);
+        std::vector<std::vector<FormulaId>> roots(threads);
+        std::vector<std::exception_ptr> errors(threads);
+        std::vector<std::thread> workers;
+
+        for (unsigned t = 0; t < threads; ++t) {
+            size_t begin = lines.size() * t / threads;
+            size_t end = lines.size() * (t + 1) / threads;
+            workers.emplace_back([&, t, begin, end]() {
+                try {
+                    parseLines(lines, begin, end, local[t], roots[t]);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (auto& w : workers)
+            w.join();
 
-    throw std::runtime_error("Unexpected symbol in CPL formula.");
+        for (unsigned t = 0; t < threads; ++t)
+            if (errors[t])
+                std::rethrow_exception(errors[t]);
+
+        for (unsigned t = 0; t < threads; ++t) {
+            std::vector<FormulaId> merged = store.merge(local[t], roots[t]);
+            formulas.insert(formulas.end(), merged.begin(), merged.end());
+        }
+    }
+    return formulas;
 }
 
-CPLFormula ModalParser::parseCPLInsideP() {
-    std::string buffer;
-    int parenDepth = 1;
+} // namespace
 
-    while (pos < input.size() && parenDepth > 0) {
-        char c = get();
+std::vector<FormulaId> loadModalFormulasFromFile(const std::string& filename, FormulaStore& store,
+                                                 LoadStats* stats, unsigned threads) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(filename);
+    std::string_view text = file.text();
 
-        if (c == '(') {
-            parenDepth++;
-            buffer += c;
-        }
-        else if (c == ')') {
-            parenDepth--;
-            if (parenDepth > 0) buffer += c;
-        }
-        else {
-            buffer += c;
-        }
+    // Instâncias convertidas com --convert: só validação e cópia
+    std::vector<FormulaId> formulas;
+    if (isBinaryInstance(text)) {
+        formulas = readBinaryInstance(text, store);
+        threads = 1;
+    } else {
+        formulas = parseText(text, store, threads);
     }
 
-    CPLParser subparser(buffer);
-    return subparser.parse();
-}
-
-// ---------- Carregar fórmulas modais de um arquivo ----------
-std::vector<ModalFormula> loadModalFormulasFromFile(const std::string& filename) {
-    std::ifstream infile(filename);
-    if (!infile) throw std::runtime_error("Could not open file: " + filename);
-
-    std::vector<ModalFormula> formulas;
-    std::string line;
-    while (std::getline(infile, line)) {
-        if (line.empty()) continue;
-        ModalParser parser(line);
-        formulas.push_back(parser.parse());
+    if (stats) {
+        stats->bytes = text.size();
+        stats->formulas = formulas.size();
+        stats->threads = threads;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
     }
     return formulas;
 }
-
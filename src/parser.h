@@ -3,53 +3,104 @@
 
 #include "formula.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
-class CPLParser {
+// ---------- Analisador léxico ----------
+
+enum class TokenKind {
+    VAR,        // identificador, só dentro de P(...)
+    P,          // P, só no nível modal
+    LPAREN,
+    RPAREN,
+    NOT,
+    AND,
+    OR,
+    IMPLIES,
+    IFF,
+    OPLUS,
+    ODOT,
+    END,
+    INVALID
+};
+
+struct Token {
+    TokenKind kind;
+    std::string_view text;  // aponta para a entrada
+};
+
+// Lexer UTF-8 de passada única sobre a entrada, sem alocação. O nível (CPL
+// ou modal) decide se 'P' é o operador de probabilidade ou início de nome.
+class Lexer {
 public:
-    explicit CPLParser(const std::string& input);
-    CPLFormula parse();
+    explicit Lexer(std::string_view input) : input(input), pos(0) {}
+    Token next(bool cpl);
 
 private:
-    std::string input;
+    std::string_view input;
     size_t pos;
-
-    char peek() const;
-    char get();
-    void skipWhitespace();
-    bool match(const std::string& expected);
-
-    CPLFormula parseFormula();
-    CPLFormula parsePrimary();
-    CPLFormula parseUnary();
-    CPLFormula parseBinary(int minPrecedence);
 };
 
-class ModalParser {
+// ---------- Analisador sintático ----------
+
+// Precedência com pilhas explícitas de operandos e operadores: fórmulas de
+// qualquer profundidade em tempo linear, sem recursão. Os operadores
+// binários associam à esquerda; ¬ tem a maior precedência.
+class FormulaParser {
 public:
-    explicit ModalParser(const std::string& input);
-    ModalFormula parse();
+    FormulaParser(std::string_view input, FormulaStore& store, bool cpl);
+    FormulaId parse();
 
 private:
-    std::string input;
-    size_t pos;
+    enum class Frame : std::uint8_t { LPAREN, PATOM, NOT, BINARY };
+
+    struct Op {
+        Frame frame;
+        bool modal;
+        std::uint8_t op;    // CPLConnective ou ModalConnective, se BINARY
+        int precedence;
+    };
 
-    char peek() const;
-    char get();
-    void skipWhitespace();
-    bool match(const std::string& expected);
+    Lexer lexer;
+    FormulaStore& store;
+    bool cplOnly;
+
+    std::vector<FormulaId> operands;
+    std::vector<Op> ops;
+
+    void pushOperand(FormulaId f);
+    void reduce();
+};
+
+// Fórmula CPL isolada
+class CPLParser : public FormulaParser {
+public:
+    CPLParser(std::string_view input, FormulaStore& store) : FormulaParser(input, store, true) {}
+};
+
+// Fórmula FP(Ł), com as fórmulas CPL dentro de P(...)
+class ModalParser : public FormulaParser {
+public:
+    ModalParser(std::string_view input, FormulaStore& store) : FormulaParser(input, store, false) {}
+};
 
-    ModalFormula parseFormula();
-    ModalFormula parsePrimary();
-    ModalFormula parseUnary();
-    ModalFormula parseBinary(int minPrecedence);
+// Estatísticas da leitura de um arquivo de entrada
+struct LoadStats {
+    size_t bytes = 0;
+    size_t formulas = 0;
+    unsigned threads = 1;
+    double seconds = 0.0;
 
-    CPLFormula parseCPLInsideP(); // usado para ler fórmulas CPL dentro de P(...)
+    double throughput() const { return seconds > 0 ? bytes / 1e6 / seconds : 0.0; }
 };
 
-// Utilitário para carregar várias fórmulas modais de um arquivo
-std::vector<ModalFormula> loadModalFormulasFromFile(const std::string& filename);
+// Utilitário para carregar várias fórmulas modais de um arquivo no armazém.
+// O arquivo é mapeado em memória e as linhas são analisadas em paralelo
+// ('threads' = 0 usa todos os núcleos; arquivos pequenos usam um só).
+// Arquivos no formato binário (ver binary_format.h) são lidos diretamente.
+std::vector<FormulaId> loadModalFormulasFromFile(const std::string& filename, FormulaStore& store,
+                                                 LoadStats* stats = nullptr, unsigned threads = 0);
 
 #endif // PARSER_HPP
 
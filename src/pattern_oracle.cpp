@@ -0,0 +1,283 @@
+#include "pattern_oracle.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+int positive(size_t var) { return 2 * static_cast<int>(var); }
+int complement(int lit) { return lit ^ 1; }
+
+} // namespace
+
+PatternOracle::PatternOracle(const FormulaStore& store, const vector<FormulaId>& nodes,
+                             const vector<int>& slot, const vector<int>& varPosition,
+                             size_t numVars_, const vector<FormulaId>& psiList)
+    : numVars(numVars_), numSatVars(numVars_)
+{
+    using C = CPLConnective;
+
+    // Cláusula sem literais repetidos; tautologias são descartadas
+    auto addClause = [&](vector<int> clause) {
+        sort(clause.begin(), clause.end());
+        clause.erase(unique(clause.begin(), clause.end()), clause.end());
+        for (size_t k = 1; k < clause.size(); ++k)
+            if (clause[k] == complement(clause[k - 1]))
+                return;
+        clauses.push_back(move(clause));
+    };
+
+    // Literal de cada subfórmula: a variável, ou uma auxiliar equivalente
+    vector<int> nodeLiteral(nodes.size());
+    for (size_t k = 0; k < nodes.size(); ++k) {
+        const FormulaNode& f = store[nodes[k]];
+        if (f.cplOp() == C::VAR) {
+            nodeLiteral[k] = positive(varPosition[f.var]);
+            continue;
+        }
+
+        int y = positive(numSatVars++);
+        int l = nodeLiteral[slot[f.left]];
+        int r = f.right != NO_FORMULA ? nodeLiteral[slot[f.right]] : 0;
+        int ny = complement(y), nl = complement(l), nr = complement(r);
+        nodeLiteral[k] = y;
+
+        switch (f.cplOp()) {
+            case C::NOT:
+                addClause({l, y});
+                addClause({nl, ny});
+                break;
+            case C::AND:
+                addClause({l, ny});
+                addClause({r, ny});
+                addClause({nl, nr, y});
+                break;
+            case C::OR:
+                addClause({nl, y});
+                addClause({nr, y});
+                addClause({l, r, ny});
+                break;
+            case C::IMPLIES:
+                addClause({nr, y});
+                addClause({l, y});
+                addClause({nl, r, ny});
+                break;
+            case C::IFF:
+                addClause({ny, nl, r});
+                addClause({ny, l, nr});
+                addClause({nl, nr, y});
+                addClause({l, r, y});
+                break;
+            default:
+                throw runtime_error("Unsupported CPL operator.");
+        }
+    }
+
+    for (FormulaId psi : psiList)
+        psiLiteral.push_back(nodeLiteral[slot[psi]]);
+
+    // Toda cláusula tem ao menos dois literais: y é nova em cada conectivo
+    watches.resize(2 * numSatVars);
+    for (size_t c = 0; c < clauses.size(); ++c) {
+        watches[clauses[c][0]].push_back(static_cast<int>(c));
+        watches[clauses[c][1]].push_back(static_cast<int>(c));
+    }
+    value.assign(numSatVars, UNASSIGNED);
+}
+
+signed char PatternOracle::literalValue(int lit) const {
+    signed char v = value[lit >> 1];
+    if (v == UNASSIGNED)
+        return UNASSIGNED;
+    return (lit & 1) ? static_cast<signed char>(1 - v) : v;
+}
+
+void PatternOracle::assign(int lit) {
+    value[lit >> 1] = (lit & 1) ? LIT_FALSE : LIT_TRUE;
+    trail.push_back(lit);
+}
+
+void PatternOracle::undo(size_t trailSize) {
+    while (trail.size() > trailSize) {
+        value[trail.back() >> 1] = UNASSIGNED;
+        trail.pop_back();
+    }
+    propagated = min(propagated, trailSize);
+}
+
+// Propagação unitária com dois literais vigiados por cláusula
+bool PatternOracle::propagate() {
+    while (propagated < trail.size()) {
+        int falseLit = complement(trail[propagated++]);
+        vector<int>& ws = watches[falseLit];
+
+        for (size_t i = 0; i < ws.size();) {
+            vector<int>& clause = clauses[ws[i]];
+            if (clause[0] == falseLit)
+                swap(clause[0], clause[1]);
+            if (literalValue(clause[0]) == LIT_TRUE) {
+                ++i;
+                continue;
+            }
+
+            // Outro literal não falso passa a ser vigiado
+            bool moved = false;
+            for (size_t k = 2; k < clause.size(); ++k) {
+                if (literalValue(clause[k]) != LIT_FALSE) {
+                    swap(clause[1], clause[k]);
+                    watches[clause[1]].push_back(ws[i]);
+                    ws[i] = ws.back();
+                    ws.pop_back();
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved)
+                continue;
+
+            if (literalValue(clause[0]) == LIT_FALSE)
+                return false;
+            assign(clause[0]);
+            ++i;
+        }
+    }
+    return true;
+}
+
+// DPLL com retrocesso cronológico a partir das atribuições correntes: no
+// conflito, inverte a decisão mais recente que ainda não foi invertida. Se
+// falha, o rastro volta ao estado inicial.
+bool PatternOracle::complete() {
+    struct Decision {
+        size_t trailSize;
+        int lit;
+        bool flipped;
+    };
+    vector<Decision> decisions;
+    size_t next = 0;
+
+    while (true) {
+        while (next < numSatVars && value[next] != UNASSIGNED)
+            ++next;
+        if (next == numSatVars)
+            return true;
+
+        decisions.push_back({trail.size(), complement(positive(next)), false});
+        assign(decisions.back().lit);
+
+        while (!propagate()) {
+            while (!decisions.empty() && decisions.back().flipped) {
+                undo(decisions.back().trailSize);
+                decisions.pop_back();
+            }
+            if (decisions.empty())
+                return false;
+
+            Decision& d = decisions.back();
+            undo(d.trailSize);
+            d.lit = complement(d.lit);
+            d.flipped = true;
+            assign(d.lit);
+            next = 0;
+        }
+    }
+}
+
+// Custo dos átomos com valor atribuído
+double PatternOracle::cost(const Query& q) const {
+    double c = q.base;
+    for (size_t i = 0; i < psiLiteral.size(); ++i) {
+        signed char v = literalValue(psiLiteral[i]);
+        if (v != UNASSIGNED && (v == LIT_TRUE) != (*q.preferred)[i])
+            c += (*q.cost)[i];
+    }
+    return c;
+}
+
+// Cada nó completa o prefixo com o DPLL: sem completamento o ramo é podado,
+// e um completamento abaixo do limite e aceito encerra a busca; senão o
+// próximo átomo livre é fixado nos dois valores
+bool PatternOracle::branch(Query& q, size_t k) {
+    if ((++nodes & 0xFF) == 0)
+        (*q.poll)();
+    if (cost(q) >= q.bound)
+        return false;
+
+    size_t mark = trail.size();
+    if (!complete())
+        return false;
+    if (cost(q) < q.bound) {
+        vector<bool> pattern(psiLiteral.size());
+        for (size_t i = 0; i < psiLiteral.size(); ++i)
+            pattern[i] = literalValue(psiLiteral[i]) == LIT_TRUE;
+        if ((*q.accept)(pattern)) {
+            vector<bool> valuation(numVars);
+            for (size_t j = 0; j < numVars; ++j)
+                valuation[j] = value[j] == LIT_TRUE;
+            q.found = move(valuation);
+        }
+    }
+    undo(mark);
+    if (q.found)
+        return true;
+
+    while (k < q.order.size() && literalValue(psiLiteral[q.order[k]]) != UNASSIGNED)
+        ++k;
+    if (k == q.order.size())
+        return false;
+
+    size_t atom = q.order[k];
+    for (bool v : {(*q.preferred)[atom], !(*q.preferred)[atom]}) {
+        assign(v ? psiLiteral[atom] : complement(psiLiteral[atom]));
+        bool done = propagate() && branch(q, k + 1);
+        undo(mark);
+        if (done)
+            return true;
+    }
+    return false;
+}
+
+optional<vector<bool>> PatternOracle::search(const vector<bool>& preferred,
+                                             const vector<double>& cost,
+                                             double base, double bound,
+                                             const function<bool(const vector<bool>&)>& accept,
+                                             const function<void()>& poll)
+{
+    Query q{&preferred, &cost, base, bound, &accept, &poll, {}, nullopt};
+    q.order.resize(psiLiteral.size());
+    for (size_t i = 0; i < q.order.size(); ++i)
+        q.order[i] = i;
+    stable_sort(q.order.begin(), q.order.end(), [&](size_t a, size_t b) { return cost[a] > cost[b]; });
+
+    undo(0);
+    if (propagate())
+        branch(q, 0);
+    undo(0);
+    return q.found;
+}
+
+optional<vector<bool>> PatternOracle::completePattern(const vector<pair<size_t, bool>>& fixed) {
+    undo(0);
+    bool consistent = true;
+    for (const auto& [atom, v] : fixed) {
+        int lit = v ? psiLiteral[atom] : complement(psiLiteral[atom]);
+        signed char current = literalValue(lit);
+        if (current == LIT_FALSE) {
+            consistent = false;
+            break;
+        }
+        if (current == UNASSIGNED)
+            assign(lit);
+    }
+
+    optional<vector<bool>> pattern;
+    if (consistent && propagate() && complete()) {
+        pattern.emplace(psiLiteral.size());
+        for (size_t i = 0; i < psiLiteral.size(); ++i)
+            (*pattern)[i] = literalValue(psiLiteral[i]) == LIT_TRUE;
+    }
+    undo(0);
+    return pattern;
+}
@@ -0,0 +1,80 @@
+#ifndef PATTERN_ORACLE_HPP
+#define PATTERN_ORACLE_HPP
+
+#include "formula.h"
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Precificação por padrões de átomos (--pricing patterns): busca os valores
+// dos ψᵢ, e uma valoração que os realize, em vez das 2^n valorações. As
+// subfórmulas CPL dos ψᵢ viram cláusulas de Tseitin (as mesmas do OPB),
+// tratadas por um DPLL com literais vigiados. O custo depende dos átomos e
+// das subfórmulas, não do número de variáveis.
+class PatternOracle {
+public:
+    // 'nodes' são as subfórmulas alcançáveis pelos ψᵢ em ordem crescente de
+    // ID, 'slot' a posição de cada uma nesse vetor e 'varPosition' a posição
+    // na valoração de cada variável do armazém
+    PatternOracle(const FormulaStore& store, const std::vector<FormulaId>& nodes,
+                  const std::vector<int>& slot, const std::vector<int>& varPosition,
+                  size_t numVars, const std::vector<FormulaId>& psiList);
+
+    // Valoração cujo padrão (valores dos ψᵢ) custa menos que 'bound' e é
+    // aceito por 'accept'. O custo é 'base' mais cost[i] para cada ψᵢ
+    // diferente de preferred[i]. Busca em profundidade nos átomos em ordem
+    // decrescente de custo, com o valor preferido primeiro; cada nó testa um
+    // completamento do prefixo, e os prefixos inconsistentes ou já caros
+    // são podados. 'poll' é chamada periodicamente e pode lançar para
+    // interromper a busca.
+    std::optional<std::vector<bool>> search(const std::vector<bool>& preferred,
+                                            const std::vector<double>& cost,
+                                            double base, double bound,
+                                            const std::function<bool(const std::vector<bool>&)>& accept,
+                                            const std::function<void()>& poll);
+
+    // Valores de todos os ψᵢ numa valoração com ψᵢ = v para cada (i, v) de
+    // 'fixed', ou nada se não há tal valoração (pré-resolução dos átomos)
+    std::optional<std::vector<bool>> completePattern(const std::vector<std::pair<size_t, bool>>& fixed);
+
+    // Nós das buscas desde a criação
+    size_t searchNodes() const { return nodes; }
+
+private:
+    enum : signed char { UNASSIGNED = -1, LIT_FALSE = 0, LIT_TRUE = 1 };
+
+    size_t numVars;                         // variáveis proposicionais (as primeiras)
+    size_t numSatVars;                      // mais uma auxiliar por conectivo
+    std::vector<std::vector<int>> clauses;  // literal: 2·var + (1 se negado)
+    std::vector<std::vector<int>> watches;  // cláusulas que vigiam cada literal
+    std::vector<int> psiLiteral;
+
+    std::vector<signed char> value;
+    std::vector<int> trail;
+    size_t propagated = 0;
+    size_t nodes = 0;
+
+    // Estado da busca corrente
+    struct Query {
+        const std::vector<bool>* preferred;
+        const std::vector<double>* cost;
+        double base;
+        double bound;
+        const std::function<bool(const std::vector<bool>&)>* accept;
+        const std::function<void()>* poll;
+        std::vector<size_t> order;          // átomos em ordem decrescente de custo
+        std::optional<std::vector<bool>> found;
+    };
+
+    signed char literalValue(int lit) const;
+    void assign(int lit);
+    void undo(size_t trailSize);
+    bool propagate();
+    bool complete();
+    double cost(const Query& q) const;
+    bool branch(Query& q, size_t k);
+};
+
+#endif // PATTERN_ORACLE_HPP
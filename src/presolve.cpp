@@ -0,0 +1,98 @@
+#include "presolve.h"
+#include "pattern_oracle.h"
+#include <algorithm>
+
+using namespace std;
+
+AtomRelations::AtomRelations(size_t numAtoms)
+    : representative(numAtoms), fixedValue(numAtoms, -1)
+{
+    for (size_t i = 0; i < numAtoms; ++i)
+        representative[i] = i;
+}
+
+size_t AtomRelations::numMerged() const {
+    size_t merged = 0;
+    for (size_t i = 0; i < representative.size(); ++i)
+        if (representative[i] != i)
+            ++merged;
+    return merged;
+}
+
+size_t AtomRelations::numFixed() const {
+    return count_if(fixedValue.begin(), fixedValue.end(), [](signed char v) { return v >= 0; });
+}
+
+AtomRelations presolveAtoms(const FormulaStore& store, const vector<FormulaId>& psis,
+                            const vector<int>& varPosition, size_t numVars, size_t maxPairAtoms,
+                            const function<void()>& poll)
+{
+    size_t m = psis.size();
+    AtomRelations relations(m);
+
+    vector<FormulaId> nodes = store.reachable(psis);
+    vector<int> slot(store.size(), -1);
+    for (size_t k = 0; k < nodes.size(); ++k)
+        slot[nodes[k]] = static_cast<int>(k);
+    PatternOracle oracle(store, nodes, slot, varPosition, numVars, psis);
+
+    // Padrões das valorações já encontradas
+    vector<vector<bool>> samples;
+    auto seen = [&](const vector<pair<size_t, bool>>& fixed) {
+        return any_of(samples.begin(), samples.end(), [&](const vector<bool>& s) {
+            return all_of(fixed.begin(), fixed.end(), [&](const pair<size_t, bool>& f) {
+                return s[f.first] == f.second;
+            });
+        });
+    };
+    auto satisfiable = [&](const vector<pair<size_t, bool>>& fixed) {
+        if (seen(fixed))
+            return true;
+        ++relations.satCalls;
+        optional<vector<bool>> pattern = oracle.completePattern(fixed);
+        if (!pattern)
+            return false;
+        samples.push_back(move(*pattern));
+        return true;
+    };
+
+    for (size_t i = 0; i < m; ++i) {
+        poll();
+        if (!satisfiable({{i, true}}))
+            relations.fixedValue[i] = 0;
+        else if (!satisfiable({{i, false}}))
+            relations.fixedValue[i] = 1;
+    }
+
+    if (m > maxPairAtoms)
+        return relations;
+
+    // Pares de átomos ainda livres; o equivalente de um átomo anterior herda
+    // as relações dele
+    auto active = [&](size_t i) { return relations.fixedValue[i] < 0 && relations.representative[i] == i; };
+    for (size_t i = 0; i < m; ++i) {
+        if (!active(i))
+            continue;
+        for (size_t j = i + 1; j < m; ++j) {
+            if (!active(j))
+                continue;
+            poll();
+
+            bool iImpliesJ = !satisfiable({{i, true}, {j, false}});
+            bool jImpliesI = !satisfiable({{i, false}, {j, true}});
+            if (iImpliesJ && jImpliesI) {
+                relations.representative[j] = i;
+                continue;
+            }
+            if (iImpliesJ)
+                relations.implications.emplace_back(i, j);
+            if (jImpliesI)
+                relations.implications.emplace_back(j, i);
+            if (!satisfiable({{i, true}, {j, true}}))
+                relations.exclusions.emplace_back(i, j);
+            if (!satisfiable({{i, false}, {j, false}}))
+                relations.covers.emplace_back(i, j);
+        }
+    }
+    return relations;
+}
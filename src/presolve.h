@@ -0,0 +1,43 @@
+#ifndef PRESOLVE_HPP
+#define PRESOLVE_HPP
+
+#include "formula.h"
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Relações clássicas entre os ψᵢ dos átomos P, válidas em toda valoração e
+// portanto entre os x(Pψᵢ) de toda distribuição:
+//   ψᵢ insatisfazível (válida)   x(Pψᵢ) = 0 (1)
+//   ψᵢ ≡ ψⱼ                     x(Pψᵢ) = x(Pψⱼ), um átomo só no PL mestre
+//   ψᵢ ⊨ ψⱼ                     x(Pψᵢ) ≤ x(Pψⱼ)
+//   ψᵢ ∧ ψⱼ insatisfazível      x(Pψᵢ) + x(Pψⱼ) ≤ 1
+//   ψᵢ ∨ ψⱼ válida              x(Pψᵢ) + x(Pψⱼ) ≥ 1
+// Índices na lista de ψ dada a presolveAtoms.
+struct AtomRelations {
+    std::vector<size_t> representative;     // menor átomo equivalente (ele mesmo se nenhum)
+    std::vector<signed char> fixedValue;    // -1: livre; 0: insatisfazível; 1: válida
+    std::vector<std::pair<size_t, size_t>> implications;
+    std::vector<std::pair<size_t, size_t>> exclusions;
+    std::vector<std::pair<size_t, size_t>> covers;
+    size_t satCalls = 0;
+
+    // Sem relações
+    explicit AtomRelations(size_t numAtoms = 0);
+
+    size_t numMerged() const;
+    size_t numFixed() const;
+};
+
+// Cada átomo é testado por SAT nos dois valores, e cada par de átomos (até
+// 'maxPairAtoms' átomos) nas quatro combinações. As valorações encontradas
+// ficam como amostras: uma combinação já vista numa delas é satisfazível e
+// não gasta outra chamada. Os ψ são fórmulas CPL do armazém; 'varPosition'
+// dá a posição na valoração de cada variável do armazém. 'poll' é chamada a
+// cada átomo e a cada par e pode lançar para interromper.
+AtomRelations presolveAtoms(const FormulaStore& store, const std::vector<FormulaId>& psis,
+                            const std::vector<int>& varPosition, size_t numVars, size_t maxPairAtoms,
+                            const std::function<void()>& poll);
+
+#endif // PRESOLVE_HPP
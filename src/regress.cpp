@@ -0,0 +1,176 @@
+#include "regress.h"
+#include "batch.h"
+#include "generator.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Medidas de uma instância da grade
+struct Measure {
+    std::string instance;   // especificação canônica do gerador
+    std::string verdict;
+    double seconds = 0.0;
+    int lpSolves = 0;
+    int columns = 0;
+};
+
+// Linha da grade: a especificação e opções próprias da instância
+struct GridEntry {
+    GeneratorSpec spec;
+    std::string name;           // especificação canônica e opções, sem espaços
+    FPOptions solver;
+    std::string expect;         // veredito exigido ("": só o do baseline)
+};
+
+std::vector<GridEntry> readGrid(const std::string& grid, const FPOptions& solver) {
+    std::ifstream in(grid);
+    if (!in)
+        throw std::runtime_error("Could not open file: " + grid);
+
+    std::vector<GridEntry> entries;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string token;
+        if (!(fields >> token) || token[0] == '#')
+            continue;
+
+        GridEntry e;
+        e.spec = parseGeneratorSpec(token);
+        e.name = toString(e.spec);
+        e.solver = solver;
+        while (fields >> token) {
+            size_t eq = token.find('=');
+            std::string key = token.substr(0, eq);
+            std::string value = eq == std::string::npos ? "" : token.substr(eq + 1);
+            if (key == "expect" && (value == "SAT" || value == "UNSAT")) {
+                e.expect = value;
+                continue;
+            }
+            if (key == "column-age" && !value.empty())
+                e.solver.columnAge = std::stoi(value);
+            else if (token == "normalize=off")
+                e.solver.normalize = false;
+            else if (token == "fast")
+                e.solver.fast = true;
+            else if (key == "cuts" && value == "off")
+                e.solver.cuts = CutMode::OFF;
+            else if (key == "cuts" && value == "root")
+                e.solver.cuts = CutMode::ROOT;
+            else if (key == "cuts" && value == "node")
+                e.solver.cuts = CutMode::NODE;
+            else
+                throw std::runtime_error("Invalid grid option: " + token);
+            e.name += ";" + token;
+        }
+        entries.push_back(e);
+    }
+    return entries;
+}
+
+std::map<std::string, Measure> readBaseline(std::ifstream& in) {
+    std::map<std::string, Measure> baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        Measure m;
+        if (!(fields >> m.instance >> m.verdict >> m.seconds >> m.lpSolves >> m.columns))
+            throw std::runtime_error("Invalid baseline line: " + line);
+        baseline[m.instance] = m;
+    }
+    return baseline;
+}
+
+void writeBaseline(const std::string& filename, const std::vector<Measure>& measures) {
+    std::ofstream out(filename);
+    if (!out)
+        throw std::runtime_error("Could not open file: " + filename);
+
+    out << "# instance verdict seconds lp_solves columns\n";
+    for (const auto& m : measures)
+        out << m.instance << " " << m.verdict << " " << std::fixed << std::setprecision(4) << m.seconds
+            << " " << m.lpSolves << " " << m.columns << "\n";
+}
+
+// Piora além do limiar: 'current' acima de 'base'·(1 + threshold) + slack
+bool regressed(double current, double base, double threshold, double slack) {
+    return current > base * (1.0 + threshold) + slack;
+}
+
+} // namespace
+
+int runRegress(const std::string& grid, const RegressOptions& options) {
+    std::vector<GridEntry> entries = readGrid(grid, options.solver);
+
+    std::map<std::string, Measure> baseline;
+    bool hasBaseline = false;
+    if (!options.updateBaseline) {
+        std::ifstream in(options.baseline);
+        if (in) {
+            baseline = readBaseline(in);
+            hasBaseline = true;
+        }
+    }
+
+    // Em sequência: as medidas de tempo não disputam núcleos
+    std::vector<Measure> measures;
+    int failures = 0;
+    for (const auto& entry : entries) {
+        Measure m;
+        m.instance = entry.name;
+        FPResult result = fplSolve({generateInstance(entry.spec)}, entry.solver);
+        m.verdict = verdictName(result);
+        m.seconds = result.seconds;
+        m.lpSolves = result.stats.lpSolves;
+        m.columns = result.columns;
+        measures.push_back(m);
+
+        std::cout << m.instance << " " << m.verdict << " " << m.seconds << " s, "
+                  << m.lpSolves << " LP solves, " << m.columns << " columns";
+
+        std::vector<std::string> problems;
+        if (!entry.expect.empty() && m.verdict != entry.expect)
+            problems.push_back("verdict " + m.verdict + ", expected " + entry.expect);
+
+        auto it = baseline.find(m.instance);
+        if (hasBaseline && it != baseline.end()) {
+            const Measure& b = it->second;
+            if (m.verdict != b.verdict)
+                problems.push_back("verdict " + b.verdict + " -> " + m.verdict);
+            if (regressed(m.seconds, b.seconds, options.threshold, options.minSeconds))
+                problems.push_back("seconds " + std::to_string(b.seconds) + " -> " + std::to_string(m.seconds));
+            if (regressed(m.lpSolves, b.lpSolves, options.threshold, 0))
+                problems.push_back("LP solves " + std::to_string(b.lpSolves) + " -> " + std::to_string(m.lpSolves));
+            if (regressed(m.columns, b.columns, options.threshold, 0))
+                problems.push_back("columns " + std::to_string(b.columns) + " -> " + std::to_string(m.columns));
+        } else if (hasBaseline) {
+            std::cout << " (not in baseline)";
+        }
+
+        for (const auto& p : problems)
+            std::cout << "\n  [REGRESSION] " << p;
+        if (!problems.empty())
+            ++failures;
+        std::cout << std::endl;
+    }
+
+    if (!hasBaseline) {
+        writeBaseline(options.baseline, measures);
+        std::cout << "Baseline recorded in " << options.baseline << " (" << measures.size() << " instances)" << std::endl;
+        if (failures > 0)
+            std::cout << failures << " instances with an unexpected verdict" << std::endl;
+        return failures;
+    }
+
+    std::cout << measures.size() << " instances, " << failures << " regressed (threshold "
+              << options.threshold * 100 << "%)" << std::endl;
+    return failures;
+}
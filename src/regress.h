@@ -0,0 +1,30 @@
+#ifndef REGRESS_HPP
+#define REGRESS_HPP
+
+#include "fplsol.h"
+#include <string>
+
+// Modo --regress: resolve, em sequência, as instâncias geradas de uma grade
+// (uma especificação do gerador por linha, '#' comenta) e compara tempo,
+// resoluções de PL e colunas com um baseline gravado antes, no formato
+//
+//   <especificação> <veredito> <segundos> <resoluções de PL> <colunas>
+//
+// Após a especificação, a linha pode trazer opções da instância
+// (column-age=<n>, cuts=<modo>, normalize=off, fast), que entram no nome
+// dela no baseline, e expect=<SAT|UNSAT>. Veredito diferente do baseline
+// ou do exigido é sempre falha; as medidas falham quando pioram mais que
+// 'threshold' (relativo), com 'minSeconds' de folga no tempo.
+struct RegressOptions {
+    FPOptions solver;
+    std::string baseline;           // arquivo do baseline
+    bool updateBaseline = false;    // regrava o baseline com as medidas atuais
+    double threshold = 0.25;
+    double minSeconds = 0.05;
+};
+
+// Número de falhas (0: sem regressão). Sem baseline, as medidas atuais
+// passam a ser o baseline e só os vereditos exigidos são conferidos.
+int runRegress(const std::string& grid, const RegressOptions& options);
+
+#endif // REGRESS_HPP
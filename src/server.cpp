@@ -0,0 +1,364 @@
+#include "server.h"
+#include "batch.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// Cliente do servidor: a entrada/saída padrão ou uma conexão do socket
+class Connection {
+public:
+    Connection(int inFd, int outFd, bool owned) : inFd(inFd), outFd(outFd), owned(owned) {}
+    ~Connection() {
+        if (owned) ::close(inFd);
+    }
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // Próxima linha, sem o '\n'; false no fim da entrada
+    bool readLine(std::string& line) {
+        while (true) {
+            size_t nl = buffer.find('\n', pos);
+            if (nl != std::string::npos) {
+                line.assign(buffer, pos, nl - pos);
+                pos = nl + 1;
+                return true;
+            }
+
+            buffer.erase(0, pos);
+            pos = 0;
+
+            char chunk[4096];
+            ssize_t n = ::read(inFd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                if (buffer.empty())
+                    return false;
+                line = std::move(buffer);
+                buffer.clear();
+                return true;
+            }
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+    }
+
+    // Escreve uma linha inteira; erros (cliente que saiu) são ignorados
+    void send(const std::string& line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        writeLocked(line);
+    }
+
+    // Encerra a leitura (desbloqueia readLine em outra thread)
+    void shutdownInput() { ::shutdown(inFd, SHUT_RD); }
+
+    std::mutex mutex;   // protege a escrita e 'pending'
+    std::map<std::string, std::shared_ptr<std::atomic<bool>>> pending;   // id -> cancelamento
+
+    void writeLocked(const std::string& line) {
+        std::string data = line + "\n";
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = ::write(outFd, data.data() + done, data.size() - done);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return;
+            done += static_cast<size_t>(n);
+        }
+    }
+
+private:
+    int inFd, outFd;
+    bool owned;
+    std::string buffer;
+    size_t pos = 0;
+};
+
+// Consulta na fila
+struct Job {
+    std::shared_ptr<Connection> conn;
+    std::string id;
+    std::vector<std::string> formulas;
+    double timeLimit;
+    std::shared_ptr<std::atomic<bool>> cancel;
+};
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::string errorJson(const std::string& id, const std::string& message) {
+    return "{\"id\":" + jsonString(id) + ",\"error\":" + jsonString(message) + "}";
+}
+
+std::string resultJson(const std::string& id, const FPResult& r) {
+    std::ostringstream out;
+    out << "{\"id\":" << jsonString(id)
+        << ",\"verdict\":" << jsonString(verdictName(r))
+        << ",\"reason\":" << jsonString(r.reason)
+        << ",\"seconds\":" << r.seconds
+        << ",\"nodes\":" << r.nodes
+        << ",\"iterations\":" << r.iterations
+        << ",\"columns\":" << r.columns
+        << ",\"stats\":" << fplStatsJson(r);
+
+    if (r.sat()) {
+        out << ",\"variables\":[";
+        for (size_t j = 0; j < r.variables.size(); ++j)
+            out << (j ? "," : "") << jsonString(r.variables[j]);
+
+        out << "],\"modal\":[";
+        for (size_t k = 0; k < r.modalValues.size(); ++k)
+            out << (k ? "," : "") << "{\"formula\":" << jsonString(r.modalValues[k].first)
+                << ",\"value\":" << r.modalValues[k].second << "}";
+
+        out << "],\"distribution\":[";
+        for (size_t k = 0; k < r.distribution.size(); ++k) {
+            const FPAtom& atom = r.distribution[k];
+            out << (k ? "," : "") << "{\"index\":" << atom.index << ",\"p\":" << atom.probability << ",\"valuation\":\"";
+            for (bool b : atom.valuation)
+                out << (b ? '1' : '0');
+            out << "\"}";
+        }
+        out << "]";
+    }
+    out << "}";
+    return out.str();
+}
+
+// Fila de consultas e threads que as resolvem, vivas durante todo o servidor
+class Server {
+public:
+    explicit Server(const ServeOptions& options) : options(options) {
+        unsigned threads = options.threads;
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned t = 0; t < threads; ++t)
+            workers.emplace_back([this]() { work(); });
+    }
+
+    // Lê os comandos da conexão até o fim da entrada, 'quit' ou 'shutdown'
+    // (retorna true no último). Com 'cancelOnClose', as consultas ainda
+    // pendentes da conexão são canceladas quando ela termina.
+    bool serve(const std::shared_ptr<Connection>& conn, bool cancelOnClose);
+
+    // Espera a fila esvaziar e encerra as threads
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            closing = true;
+        }
+        queueReady.notify_all();
+        for (auto& w : workers)
+            w.join();
+    }
+
+private:
+    const ServeOptions& options;
+    std::deque<Job> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    bool closing = false;
+    std::vector<std::thread> workers;
+
+    void submit(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(std::move(job));
+        }
+        queueReady.notify_one();
+    }
+
+    void work() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueReady.wait(lock, [this]() { return closing || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            FPOptions solverOptions = options.solver;
+            solverOptions.timeLimit = job.timeLimit;
+            solverOptions.cancel = job.cancel.get();
+
+            std::string response;
+            try {
+                response = resultJson(job.id, fplSolve(job.formulas, solverOptions));
+            } catch (const std::exception& e) {
+                response = "{\"id\":" + jsonString(job.id) + ",\"verdict\":\"ERROR\",\"reason\":" +
+                           jsonString(e.what()) + "}";
+            }
+
+            // O id fica livre para reuso assim que a resposta sai
+            std::lock_guard<std::mutex> lock(job.conn->mutex);
+            job.conn->pending.erase(job.id);
+            job.conn->writeLocked(response);
+        }
+    }
+};
+
+bool Server::serve(const std::shared_ptr<Connection>& conn, bool cancelOnClose) {
+    bool shutdown = false;
+    std::string line;
+
+    while (conn->readLine(line)) {
+        std::istringstream in(trim(line));
+        std::string command, id;
+        in >> command >> id;
+
+        if (command.empty()) {
+            continue;
+        } else if (command == "solve") {
+            double timeLimit = options.solver.timeLimit;
+            if (!(in >> timeLimit))
+                timeLimit = options.solver.timeLimit;
+
+            // Fórmulas até 'end'; a entrada pode acabar no meio da consulta
+            std::vector<std::string> formulas;
+            bool complete = false;
+            while (conn->readLine(line)) {
+                std::string formula = trim(line);
+                if (formula == "end") {
+                    complete = true;
+                    break;
+                }
+                if (!formula.empty())
+                    formulas.push_back(formula);
+            }
+            if (!complete)
+                break;
+
+            if (id.empty()) {
+                conn->send(errorJson(id, "Missing request id."));
+                continue;
+            }
+
+            auto cancel = std::make_shared<std::atomic<bool>>(false);
+            {
+                std::lock_guard<std::mutex> lock(conn->mutex);
+                if (!conn->pending.emplace(id, cancel).second) {
+                    conn->writeLocked(errorJson(id, "Duplicate request id."));
+                    continue;
+                }
+            }
+            submit(Job{conn, id, std::move(formulas), timeLimit, cancel});
+        } else if (command == "cancel") {
+            std::lock_guard<std::mutex> lock(conn->mutex);
+            auto it = conn->pending.find(id);
+            if (it != conn->pending.end())
+                it->second->store(true);
+            else
+                conn->writeLocked(errorJson(id, "Unknown request id."));
+        } else if (command == "quit") {
+            break;
+        } else if (command == "shutdown") {
+            shutdown = true;
+            break;
+        } else {
+            conn->send(errorJson(id, "Unknown command: " + command));
+        }
+    }
+
+    if (cancelOnClose) {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        for (auto& [id, cancel] : conn->pending)
+            cancel->store(true);
+    }
+    return shutdown;
+}
+
+void serveSocket(Server& server, const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Socket path too long: " + path);
+    std::copy(path.begin(), path.end(), addr.sun_path);
+
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0)
+        throw std::runtime_error("Could not create socket: " + path);
+    ::unlink(path.c_str());
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listenFd, 64) != 0) {
+        ::close(listenFd);
+        throw std::runtime_error("Could not listen on socket: " + path);
+    }
+
+    // Uma thread de leitura por conexão; 'shutdown' fecha o socket de escuta
+    // e a leitura das demais conexões
+    std::mutex connMutex;
+    std::vector<std::weak_ptr<Connection>> connections;
+    std::vector<std::thread> readers;
+    std::atomic<bool> stopping{false};
+
+    while (true) {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR && !stopping)
+                continue;
+            break;
+        }
+
+        auto conn = std::make_shared<Connection>(fd, fd, true);
+        {
+            std::lock_guard<std::mutex> lock(connMutex);
+            connections.push_back(conn);
+        }
+        readers.emplace_back([&, conn]() {
+            if (!server.serve(conn, true) || stopping.exchange(true))
+                return;
+            ::shutdown(listenFd, SHUT_RDWR);
+            std::lock_guard<std::mutex> lock(connMutex);
+            for (auto& weak : connections)
+                if (auto other = weak.lock())
+                    other->shutdownInput();
+        });
+    }
+
+    for (auto& r : readers)
+        r.join();
+    ::close(listenFd);
+    ::unlink(path.c_str());
+}
+
+} // namespace
+
+void runServer(const ServeOptions& options) {
+    // Cliente que fecha a conexão não derruba o servidor
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Server server(options);
+    try {
+        if (options.socket.empty())
+            server.serve(std::make_shared<Connection>(STDIN_FILENO, STDOUT_FILENO, false), false);
+        else
+            serveSocket(server, options.socket);
+    } catch (...) {
+        server.stop();
+        throw;
+    }
+    server.stop();
+}
@@ -0,0 +1,29 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "fplsol.h"
+#include <string>
+
+// Modo --serve: processo de longa duração que atende consultas pela entrada
+// padrão ou por um socket Unix. Protocolo em linhas de texto:
+//
+//   solve <id> [<timeout em s>]   abre uma consulta; as linhas seguintes são
+//   <fórmula modal>               as fórmulas, uma por linha, até 'end'
+//   end
+//   cancel <id>                   cancela uma consulta na fila ou em curso
+//   quit                          fecha a conexão (na entrada padrão, encerra
+//                                 após as consultas pendentes)
+//   shutdown                      encerra o servidor (socket)
+//
+// Cada consulta é resolvida por um conjunto fixo de threads e responde com
+// uma linha JSON, marcada com o <id>, assim que termina; consultas da mesma
+// conexão podem responder fora de ordem.
+struct ServeOptions {
+    FPOptions solver;       // timeLimit: padrão das consultas sem timeout
+    unsigned threads = 0;   // 0: todos os núcleos
+    std::string socket;     // caminho do socket Unix (vazio: entrada padrão)
+};
+
+void runServer(const ServeOptions& options);
+
+#endif // SERVER_HPP
@@ -1,6 +1,12 @@
 #include "solver.h"
+#include "checkpoint.h"
+#include "column_cache.h"
 #include "formula.h"
 #include "linear_program.h"
+#include "normalize.h"
+#include "parser.h"
+#include "presolve.h"
+#include "trace.h"
 #include <iostream>
 #include <stdexcept>
 #include <set>
@@ -14,20 +20,82 @@
 #include <sstream>
 #include <filesystem>
 #include <optional>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <sys/resource.h>
+#include <unistd.h>
 
 using namespace std;
 
 // ----------- Construtor -----------
 
-FPSolver::FPSolver(vector<ModalFormula> formulas_, string inputFilename_, bool verbose_) :
-    formulas(move(formulas_)),
-    inputFilename(inputFilename_),
-    verbose(verbose_)
+FPSolver::FPSolver(FormulaStore store_, vector<FormulaId> formulas_, bool verbose_) :
+    verbose(verbose_),
+    store(move(store_)),
+    inputFormulas(move(formulas_))
 {
-    // cout << "Iniciando solver FP(Ł)..." << endl;
-    cout << "Initiating FP(Ł) solver..." << endl;
+}
+
+// ----------- Uso incremental -----------
+
+FormulaId FPSolver::addFormula(string_view text) {
+    ModalParser parser(text, store);
+    FormulaId f = parser.parse();
+    addFormula(f);
+    return f;
+}
+
+void FPSolver::addFormula(FormulaId formula) {
+    inputFormulas.push_back(formula);
+    preprocessed = false;
+}
+
+void FPSolver::push() {
+    scopes.push_back(inputFormulas.size());
+}
+
+void FPSolver::pop() {
+    if (scopes.empty())
+        throw runtime_error("pop without matching push.");
+
+    inputFormulas.resize(scopes.back());
+    scopes.pop_back();
+    preprocessed = false;
+
+    // Um subconjunto do prefixo UNSAT pode ser satisfazível
+    if (unsatPrefix > inputFormulas.size())
+        unsatPrefix = 0;
+}
+
+void FPSolver::rememberSolution(const map<string, int>& openBranch) {
+    lastOpenBranch = openBranch;
+
+    // Suporte da distribuição, nas variáveis do armazém: colunas iniciais
+    // das próximas chamadas (valem para quaisquer fórmulas)
+    constexpr size_t maxSeeds = 1024;
+    for (size_t i = 0; i < lastValuations.size(); ++i) {
+        if (lastProbDistribution[i] <= 0)
+            continue;
+
+        vector<bool> seed(store.numVars(), false);
+        for (size_t j = 0; j < valuationVars.size(); ++j)
+            seed[valuationVars[j]] = lastValuations[i][j];
+        if (find(seedValuations.begin(), seedValuations.end(), seed) == seedValuations.end())
+            seedValuations.push_back(move(seed));
+    }
+    if (seedValuations.size() > maxSeeds)
+        seedValuations.erase(seedValuations.begin(), seedValuations.end() - maxSeeds);
+}
 
-    preprocess();
+void FPSolver::setLog(ostream* out) {
+    log.rdbuf(out ? out->rdbuf() : nullptr);
 }
 
 // ----------- Configura o PB solver -----------
@@ -37,76 +105,448 @@ void FPSolver::setPBOptions(bool usePBFlag, const string& pbSolverPath, const st
     pbSolver = pbSolverPath;
     pbArg = pbArguments;
 
-    string command = "which " + pbSolverPath + " > /dev/null";
+    if (!usePB)
+        return;
+
+    // Uma verificação por caminho e processo (várias instâncias em --batch)
+    static mutex probeMutex;
+    static map<string, bool> available;
+    bool found;
+    {
+        lock_guard<mutex> lock(probeMutex);
+        auto it = available.find(pbSolverPath);
+        if (it == available.end()) {
+            string command = "which " + pbSolverPath + " > /dev/null";
+            it = available.emplace(pbSolverPath, std::system(command.c_str()) == 0).first;
+        }
+        found = it->second;
+    }
 
-    if (std::system(command.c_str()) != 0) {
-        cout << "[Fusca] Column generation via exhaustive search." << endl;
+    if (!found) {
+        log << "[Fusca] Column generation via exhaustive search." << endl;
         usePB = false;
     }
 }
 
-// ----------- Função auxiliar: coleta subfórmulas atômicas Pφ -----------
+// ----------- Configura a normalização das fórmulas -----------
 
-static void collectPatoms(const ModalFormula& f, vector<unique_ptr<CPLFormula>>& out) {
-    using M = ModalConnective;
-    if (f.op == M::P_ATOM && f.atom)
-        out.push_back(f.atom->clone());
-    else {
-        if (f.left) collectPatoms(*f.left, out);
-        if (f.right) collectPatoms(*f.right, out);
-    }
+void FPSolver::setNormalize(bool enabled) {
+    normalizeEnabled = enabled;
+}
+
+// ----------- Configura o envelhecimento de colunas -----------
+
+void FPSolver::setColumnAging(int limit, double threshold) {
+    columnAgeLimit = limit;
+    columnAgeThreshold = threshold;
+}
+
+// ----------- Configura as tolerâncias numéricas -----------
+
+void FPSolver::setFastMode(bool fast) {
+    fastMode = fast;
+    acceptTolerance = fast ? 1e-6 : 0.0;
+    pricingTolerance = fast ? 1e-6 : 0.0;
+    pbScale = fast ? 1e4 : 1e6;
+    lpTolerance = fast ? 1e-5 : 1e-6;
+}
+
+// ----------- Configura os arquivos de análise -----------
+
+void FPSolver::setDumpOptions(const string& dir, int limit) {
+    dumpDir = dir;
+    dumpLimit = limit;
+    if (!dumpDir.empty())
+        filesystem::create_directories(dumpDir);
+}
+
+void FPSolver::dumpNode(const LinearProgram& lp, int node) {
+    if (dumpDir.empty() || node >= dumpLimit)
+        return;
+
+    filesystem::path base = filesystem::path(dumpDir) / (node == 0 ? string("root") : "node_" + to_string(node));
+    lp.writeToFile(base.string() + ".lp");
+    if (node != 0)
+        return;
+
+    lp.writeToFile(base.string() + ".mps");
+
+    // Os nomes x(·)/b(·) usam o ID da subfórmula; a tabela dá o texto
+    ofstream table(filesystem::path(dumpDir) / "formulas.txt");
+    for (FormulaId id : store.reachable(formulas))
+        if (store[id].modal)
+            table << id << " " << store.toString(id) << "\n";
+}
+
+// ----------- Estatísticas -----------
+
+namespace {
+
+// Soma a duração do escopo em 'total'
+class ScopedTimer {
+public:
+    explicit ScopedTimer(double& total) : total(total), start(chrono::steady_clock::now()) {}
+    ~ScopedTimer() { total += chrono::duration<double>(chrono::steady_clock::now() - start).count(); }
+
+private:
+    double& total;
+    chrono::steady_clock::time_point start;
+};
+
+} // namespace
+
+bool FPSolver::solveLP(LinearProgram& lp) {
+    ++stats.lpSolves;
+    stats.peakRows = max(stats.peakRows, lp.numRows());
+    stats.peakCols = max(stats.peakCols, lp.numCols());
+    ScopedTimer timer(stats.lpSeconds);
+    TraceSpan span("LinearProgram::solve", "rows", lp.numRows());
+    return lp.solve();
 }
 
 // ----------- Pré-processamento -----------
 
 void FPSolver::preprocess() {
-    for (const auto& f : formulas)
-        f.collectPropVars(propVarToId);
+    // cout << "Iniciando solver FP(Ł)..." << endl;
+    log << "Initiating FP(Ł) solver..." << endl;
+
+    formulas = inputFormulas;
+    normalizedUnsat = false;
+    if (normalizeEnabled) {
+        ScopedTimer timer(stats.normalizeSeconds);
+        TraceSpan span("normalize");
+        NormalizeStats stats;
+        Normalizer normalizer(store);
+        normalizedUnsat = !normalizer.normalize(formulas, stats);
+
+        if (verbose)
+            log << "[Normalize] x variables: " << stats.xBefore << " -> " << stats.xAfter
+                << ", binaries: " << stats.bBefore << " -> " << stats.bAfter << endl;
+    }
+
+    // Variáveis que a normalização eliminou não entram nas valorações
+    propVarToId.assign(store.numVars(), -1);
+    varList.clear();
+    valuationVars = store.variables(formulas);
+    for (int v : valuationVars) {
+        propVarToId[v] = static_cast<int>(varList.size());
+        varList.push_back(store.varName(v));
+    }
+
+    // cout << "Detectadas " << varList.size() << " variáveis proposicionais." << endl;
+}
+
+// ----------- Limites -----------
+
+namespace {
+
+// Interrupção por limite ou cancelamento; solve a converte em UNKNOWN
+struct Interrupted {
+    const char* reason;
+};
+
+// Memória residente do processo em bytes (0 se indisponível)
+size_t residentBytes() {
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident))
+        return 0;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+} // namespace
 
-    varList.resize(propVarToId.size());
-    for (const auto& [v, id] : propVarToId)
-        varList[id] = v;
+void FPSolver::setLimits(double limit, const atomic<bool>* cancel) {
+    timeLimit = limit;
+    cancelFlag = cancel;
+}
+
+void FPSolver::setResourceLimits(long nodes, double memLimitMB) {
+    nodeLimit = nodes;
+    memLimitBytes = memLimitMB > 0 ? static_cast<size_t>(memLimitMB * 1024 * 1024) : 0;
+}
+
+void FPSolver::setProgressInterval(double seconds) {
+    progressInterval = seconds;
+}
+
+void FPSolver::setCheckpoint(const string& file, double interval) {
+    checkpointFile = file;
+    checkpointInterval = interval;
+}
+
+void FPSolver::setResume(const string& file) {
+    resumeFile = file;
+}
 
-    // cout << "Detectadas " << propVarToId.size() << " variáveis proposicionais." << endl;
+void FPSolver::setColumnCache(const string& dir) {
+    columnCacheDir = dir;
+}
+
+void FPSolver::setDecompose(bool enabled) {
+    decomposeEnabled = enabled;
+}
+
+void FPSolver::checkLimits() {
+    if ((cancelFlag && cancelFlag->load(memory_order_relaxed)) ||
+        (componentStop && componentStop->load(memory_order_relaxed)))
+        throw Interrupted{"cancelled"};
+
+    if (timeLimit > 0 || progressInterval > 0) {
+        auto now = chrono::steady_clock::now();
+        if (timeLimit > 0 && now >= deadline)
+            throw Interrupted{"time limit reached"};
+        if (progressInterval > 0 && now >= nextProgress) {
+            reportProgress(now);
+            nextProgress = now + chrono::duration_cast<chrono::steady_clock::duration>(
+                                     chrono::duration<double>(progressInterval));
+        }
+    }
+
+    // A memória é amostrada a cada 32 chamadas; perto do limite a busca
+    // passa a ser em profundidade, que guarda só um caminho de PLs
+    if (memLimitBytes > 0 && (++limitChecks & 31) == 0) {
+        size_t rss = residentBytes();
+        if (rss >= memLimitBytes)
+            throw Interrupted{"memory limit reached"};
+        if (!lowMemory && rss >= memLimitBytes / 10 * 8) {
+            lowMemory = true;
+            log << "[Limits] Resident memory at " << rss / (1024 * 1024)
+                << " MB, switching to depth-first exploration." << endl;
+        }
+    }
+}
+
+void FPSolver::reportProgress(chrono::steady_clock::time_point now) {
+    log << "[Progress] " << fixed << setprecision(1)
+        << chrono::duration<double>(now - solveStart).count() << " s, "
+        << totalNodes << " nodes (" << stats.nodesClosed << " closed, " << stats.nodesPruned << " pruned), "
+        << openNodes << " open, " << maxDepth << "/" << numBinaries << " binaries fixed, best Phase-I objective ";
+    if (bestObjective < numeric_limits<double>::infinity())
+        log << defaultfloat << setprecision(6) << bestObjective;
+    else
+        log << "-";
+    log << defaultfloat << setprecision(6);
+    if (memLimitBytes > 0)
+        log << ", " << residentBytes() / (1024 * 1024) << " MB";
+    log << endl;
 }
 
 // ----------- Solver principal -----------
 
 bool FPSolver::solve() {
-    auto rootLP = make_unique<LinearProgram>();
-    unordered_map<string, int> xVars, bVars;
-    vector<unique_ptr<CPLFormula>> psiList;
+    auto start = chrono::steady_clock::now();
+    deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(timeLimit));
+    solveStart = start;
+    nextProgress = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(progressInterval));
+    nextCheckpoint = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(checkpointInterval));
+    resumedSeconds = 0.0;
+    usefulColumns.clear();
+    totalNodes = totalIterations = totalColumns = 0;
+    stats = FPStats{};
+    lowMemory = false;
+    openNodes = maxDepth = numBinaries = 0;
+    bestObjective = numeric_limits<double>::infinity();
+
+    TraceSpan span("solve");
+    bool sat;
+    try {
+        if (!preprocessed) {
+            preprocess();
+            preprocessed = true;
+        }
+
+        // Acrescentar fórmulas a um conjunto insatisfazível não o torna satisfazível
+        if (unsatPrefix > 0) {
+            sat = finish(FPStatus::UNSAT, "subset already unsatisfiable");
+        } else {
+            vector<vector<FormulaId>> components;
+            if (decomposeEnabled && !normalizedUnsat && checkpointFile.empty() && resumeFile.empty())
+                components = findComponents();
+            sat = components.size() > 1 ? solveComponents(components) : search();
+        }
+    } catch (const Interrupted& e) {
+        sat = finish(FPStatus::UNKNOWN, e.reason);
+    }
+
+    if (!columnCachePath.empty() && !usefulColumns.empty())
+        saveColumnCache();
+
+    if (lastResult.status == FPStatus::UNSAT && unsatPrefix == 0)
+        unsatPrefix = inputFormulas.size();
+
+    lastResult.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    lastResult.nodes = totalNodes;
+    lastResult.iterations = totalIterations;
+    lastResult.columns = totalColumns;
+
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        stats.peakRssKB = usage.ru_maxrss;
+    lastResult.stats = stats;
+    return sat;
+}
+
+bool FPSolver::search() {
+    if (normalizedUnsat)
+        return finish(FPStatus::UNSAT, "formula simplifies to ⊥");
+
+    vector<int> xVars;              // índice da coluna x(·) por FormulaId (-1 se não há)
+    vector<FormulaId> psiList;      // fórmulas ψᵢ dos átomos Pψᵢ, sem repetição
     vector<int> probConstraintRows;
+    int sumProbRow;
+
+    nodeCounter = 0;
+    dumpedPricing = 0;
+    auto rootLP = buildRootLP(xVars, psiList, probConstraintRows, sumProbRow);
+    loadColumnCache();
+
+    // Sem o solver PB, padrões dos átomos P no modo automático quando há
+    // menos átomos que variáveis ou mais de maxExhaustiveVars variáveis
+    patternPricing = !usePB && (pricingMode == PricingMode::PATTERNS ||
+                                (pricingMode == PricingMode::AUTO &&
+                                 (psiList.size() < varList.size() || varList.size() > maxExhaustiveVars)));
+    if (!usePB && !patternPricing && varList.size() > 30)
+        throw runtime_error("Exhaustive pricing supports at most 30 variables; use --pricing patterns");
+    patternOracle.reset();
+    if (patternPricing)
+        patternOracle = make_unique<PatternOracle>(store, psiNodes, psiSlot, propVarToId, varList.size(), psiList);
+
+    set<string> binaries = rootLP->getBinaryVariableNames();
+    detectSymmetries(psiList, binaries);
+
+    auto inputRootLP = rootLP->clone();
+    if (!isFeasible(psiList, move(inputRootLP), xVars, probConstraintRows, sumProbRow)) {
+        return finish(FPStatus::UNSAT, "infeasible relaxed problem");
+    }
+
+    vector<Branch> branches;
+    vector<vector<bool>> rootColumns;
+    if (!checkpointFile.empty())
+        rootColumns = lastValuations;
+    if (!checkpointFile.empty() || !resumeFile.empty())
+        searchFingerprint = fingerprint(binaries);
+
+    // Retomada: a busca continua dos ramos gravados, sem a partida a quente
+    bool resumed = !resumeFile.empty();
+    if (resumed) {
+        vector<Branch> start = resumeBranches(*rootLP, binaries, psiList, xVars, probConstraintRows, sumProbRow);
+        if (!start.empty())
+            branches = explore(move(start), binaries, psiList, xVars, probConstraintRows, sumProbRow);
+    }
+
+    // Partida a quente: fixa as binárias que ainda existem como no último
+    // ramo aberto (os nomes b(<id>) são estáveis no armazém). Se o
+    // subproblema fecha, a busca recomeça da raiz.
+    if (!resumed && !lastOpenBranch.empty()) {
+        auto diveLP = rootLP->clone();
+        map<string, int> fixed;
+        set<string> rest = binaries;
+        for (const auto& [b, val] : lastOpenBranch) {
+            if (rest.erase(b)) {
+                diveLP->addConstraint({{diveLP->getVarIndex(b), 1.0}}, LinearProgram::EQ, val);
+                fixed[b] = val;
+            }
+        }
+
+        if (!fixed.empty() && isFeasible(psiList, diveLP->clone(), xVars, probConstraintRows, sumProbRow)) {
+            vector<Branch> start;
+            start.push_back(Branch{move(diveLP), fixed});
+            if (!checkpointFile.empty())
+                start.back().columns = lastValuations;
+            branches = explore(move(start), rest, psiList, xVars, probConstraintRows, sumProbRow);
+        }
+        if (verbose)
+            log << "  [Incremental] Warm start from previous open branch ("
+                << fixed.size() << " binaries fixed): " << (branches.empty() ? "closed" : "open") << "\n";
+    }
 
-    for (const auto& f : formulas)
-        encodeModalFormula(f, *rootLP, xVars, bVars);
+    if (!resumed && branches.empty()) {
+        vector<Branch> start;
+        start.push_back(Branch{move(rootLP), {}});
+        start.back().columns = move(rootColumns);
+        branches = explore(move(start), binaries, psiList, xVars, probConstraintRows, sumProbRow);
+    }
 
-    for (const auto& f : formulas) {
-        string id = f.toString();
-        if (!xVars.count(id))
-            throw runtime_error("FP(Ł) formula not translated: " + id);
-        rootLP->addConstraint({{xVars[id], 1.0}}, LinearProgram::EQ, 1.0);
+    if (branches.empty()) {
+        return finish(FPStatus::UNSAT, "all branches closed");
+    }
 
+    // Modo rápido: o veredito SAT só vale após a verificação exata do nó
+    // aceito por último (a última folha aberta)
+    if (fastMode) {
+        if (certifySolution(psiList, *branches.back().lp, probConstraintRows, sumProbRow)) {
+            if (verbose)
+                log << "  [Certify] SAT verdict certified by exact rational solve of the reduced master.\n";
+        } else {
+            log << "[Certify] Certification failed, re-solving with conservative tolerances." << endl;
+            // O solver é reutilizado (biblioteca, serve, push/pop): o modo
+            // rápido volta ao fim da nova busca
+            setFastMode(false);
+            bool sat;
+            try {
+                sat = search();
+            } catch (...) {
+                setFastMode(true);
+                throw;
+            }
+            setFastMode(true);
+            return sat;
+        }
     }
 
-    for (const auto& f : formulas)
-        collectPatoms(f, psiList);
+    rememberSolution(branches.back().fixedBinaries);
+    return finish(FPStatus::SAT, "open branch found");
+}
+
+// PL mestre da raiz (Fase I): gadgets, fórmulas = 1, linhas dos átomos
+// Pψᵢ e da soma das probabilidades, artificiais i(·) e cortes
+unique_ptr<LinearProgram> FPSolver::buildRootLP(vector<int>& xVars, vector<FormulaId>& psiList,
+                                                vector<int>& probConstraintRows, int& sumProbRow)
+{
+    auto encodeStart = chrono::steady_clock::now();
+    auto rootLP = make_unique<LinearProgram>();
+    psiList.clear();
+    probConstraintRows.clear();
+    cutPool.clear();
+    relationPool.clear();
+    encodeModalFormulas(*rootLP, xVars);
+
+    for (FormulaId f : formulas)
+        rootLP->addConstraint({{xVars[f], 1.0}}, LinearProgram::EQ, 1.0);
+
+    vector<FormulaId> atoms, atomPsis;      // nós Pψ e seus ψ
+    for (FormulaId id : store.reachable(formulas)) {
+        if (store[id].modal && store[id].modalOp() == ModalConnective::P_ATOM) {
+            atoms.push_back(id);
+            atomPsis.push_back(store[id].left);
+        }
+    }
 
-    for (const auto& psiPtr : psiList) {
-        ModalFormula patom = ModalFormula::patom(*psiPtr);
-        string id = patom.toString();
+    // Átomos equivalentes a outro e os fixados não entram no PL mestre
+    AtomRelations relations(atoms.size());
+    double presolveSeconds = 0.0;
+    if (presolveEnabled && !atoms.empty()) {
+        ScopedTimer timer(presolveSeconds);
+        TraceSpan span("presolve");
+        relations = presolveAtoms(store, atomPsis, propVarToId, varList.size(), maxPresolvePairAtoms,
+                                  [&] { checkLimits(); });
+    }
+    stats.presolveSeconds += presolveSeconds;
 
-        if (!xVars.count(id))
-            throw runtime_error("Variable x(" + id + ") not found.");
+    for (size_t k = 0; k < atoms.size(); ++k) {
+        if (relations.fixedValue[k] >= 0 || relations.representative[k] != k)
+            continue;
 
-        int xIdx = xVars.at(id);
+        psiList.push_back(atomPsis[k]);
         // Só o termo -x_{Pψᵢ}
-        rootLP->addConstraint({{xIdx, -1.0}}, LinearProgram::EQ, 0.0);
+        rootLP->addConstraint({{xVars[atoms[k]], -1.0}}, LinearProgram::EQ, 0.0);
         probConstraintRows.push_back(rootLP->numRows() - 1);
     }
+    indexPsiNodes(psiList);
 
     rootLP->addConstraint({}, LinearProgram::EQ, 1.0);
-    int sumProbRow = rootLP->numRows() - 1;
+    sumProbRow = rootLP->numRows() - 1;
 
     int numInitialRows = rootLP->numRows();
     vector<int> iVarIndices;
@@ -124,105 +564,700 @@ bool FPSolver::solve() {
 
     rootLP->setMinimizationObjective();
 
-    auto inputRootLP = rootLP->clone();
-    if (!isFeasible(psiList, propVarToId, move(inputRootLP), xVars, probConstraintRows, sumProbRow)) {
-        if (verbose) cout << endl;
-        cout << "UNSAT (infeasible relaxed problem)" << endl;
-        return false;
+    // Relações da pré-resolução: válidas para toda distribuição, sem
+    // variáveis artificiais, como os cortes. Fixações e fusões entram no PL
+    // raiz; implicações, exclusões e coberturas, se pedidas, só quando a
+    // solução corrente as viola (ver isFeasible)
+    auto x = [&](size_t k) { return xVars[atoms[k]]; };
+    for (size_t k = 0; k < atoms.size(); ++k) {
+        if (relations.fixedValue[k] >= 0)
+            rootLP->addConstraint({{x(k), 1.0}}, LinearProgram::EQ, relations.fixedValue[k]);
+        else if (relations.representative[k] != k)
+            rootLP->addConstraint({{x(k), 1.0}, {x(relations.representative[k]), -1.0}}, LinearProgram::EQ, 0.0);
+    }
+    if (presolveRelations) {
+        for (const auto& [i, j] : relations.implications)
+            relationPool.add({{{x(i), 1.0}, {x(j), -1.0}}, LinearProgram::LE, 0.0});
+        for (const auto& [i, j] : relations.exclusions)
+            relationPool.add({{{x(i), 1.0}, {x(j), 1.0}}, LinearProgram::LE, 1.0});
+        for (const auto& [i, j] : relations.covers)
+            relationPool.add({{{x(i), 1.0}, {x(j), 1.0}}, LinearProgram::GE, 1.0});
     }
 
-    set<string> binaries = rootLP->getBinaryVariableNames();
-    vector<Branch> branches;
-    branches.push_back(Branch{move(rootLP), {}});
+    size_t numRelations = relations.implications.size() + relations.exclusions.size() + relations.covers.size();
+    stats.atomsMerged = static_cast<int>(relations.numMerged());
+    stats.atomsFixed = static_cast<int>(relations.numFixed());
+    stats.atomRelations = static_cast<int>(numRelations);
+    if (verbose && presolveEnabled && !atoms.empty())
+        log << "[Presolve] P atoms: " << atoms.size() << " -> " << psiList.size() << " ("
+            << stats.atomsMerged << " merged, " << stats.atomsFixed << " fixed), "
+            << numRelations << " relations, " << relations.satCalls << " SAT calls" << endl;
+
+    // Facetas dos gadgets: sem variáveis artificiais, pois são válidas
+    // para toda solução inteira e sempre satisfazíveis com os x em [0,1]
+    if (cutMode == CutMode::ROOT) {
+        int numCuts = cutPool.addAll(*rootLP);
+        if (verbose)
+            log << "  [Cuts] " << numCuts << " gadget facets added to root LP.\n";
+    }
+    auto encodeEnd = chrono::steady_clock::now();
+    stats.encodeSeconds += chrono::duration<double>(encodeEnd - encodeStart).count() - presolveSeconds;
+    if (trace::enabled.load(memory_order_relaxed))
+        trace::record("encode", encodeStart, encodeEnd, nullptr, 0);
+    return rootLP;
+}
+
+// Fixa as binárias em ordem de nome a partir dos ramos dados: em largura
+// (fila), ou em profundidade (pilha) quando a memória se aproxima do limite;
+// as que um ramo já fixou são puladas. Devolve o primeiro ramo aberto com
+// todas as binárias fixadas, ou nada se todos os ramos fecham. Com
+// checkpoint, a fronteira é gravada a cada intervalo e na interrupção.
+vector<FPSolver::Branch> FPSolver::explore(vector<Branch> branches, set<string> binaries,
+                                           const vector<FormulaId>& psiList, const vector<int>& xVars,
+                                           const vector<int>& probConstraintRows, int sumProbRow)
+{
+    vector<string> order(binaries.begin(), binaries.end());
+    numBinaries = order.size();
+    maxDepth = 0;
+
+    auto skipFixed = [&](Branch& br) {
+        while (br.depth < order.size() && br.fixedBinaries.count(order[br.depth]))
+            ++br.depth;
+    };
 
-    while (!branches.empty() && !binaries.empty()) {
-        string b;
-        b = *binaries.begin();
-        binaries.erase(b);
+    deque<Branch> frontier;
+    for (auto& br : branches) {
+        br.depth = 0;
+        skipFixed(br);
+        frontier.push_back(move(br));
+    }
+
+    vector<Branch> open;
+    while (!frontier.empty()) {
+        if (!checkpointFile.empty()) {
+            auto now = chrono::steady_clock::now();
+            if (now >= nextCheckpoint) {
+                saveCheckpoint(frontier);
+                nextCheckpoint = now + chrono::duration_cast<chrono::steady_clock::duration>(
+                                           chrono::duration<double>(checkpointInterval));
+            }
+        }
+
+        Branch br = move(lowMemory ? frontier.back() : frontier.front());
+        if (lowMemory)
+            frontier.pop_back();
+        else
+            frontier.pop_front();
 
-        vector<Branch> next;
+        if (br.depth == order.size()) {
+            open.push_back(move(br));
+            return open;
+        }
 
-        for (auto& br : branches) {
+        const string& b = order[br.depth];
+        size_t pushed = 0;
+        try {
             for (int val : {0, 1}) {
-                auto newLP = br.lp->clone();
-                newLP->addConstraint({{newLP->getVarIndex(b), 1.0}}, LinearProgram::EQ, val);
-                auto inputNewLP = newLP->clone();
-                if (isFeasible(psiList, propVarToId, move(inputNewLP), xVars, probConstraintRows, sumProbRow)) {
-                    auto fixed = br.fixedBinaries;
-                    fixed[b] = val;
-                    next.push_back(Branch{move(newLP), fixed});
+                checkLimits();
+                auto fixed = br.fixedBinaries;
+                fixed[b] = val;
+                if (symmetricBranch(fixed)) {
+                    ++stats.nodesSymmetric;
+                    continue;
                 }
+
+                unique_ptr<LinearProgram> newLP, inputNewLP;
+                {
+                    TraceSpan span("branch", "value", val);
+                    newLP = br.lp->clone();
+                    newLP->addConstraint({{newLP->getVarIndex(b), 1.0}}, LinearProgram::EQ, val);
+                    inputNewLP = newLP->clone();
+                }
+                if (isFeasible(psiList, move(inputNewLP), xVars, probConstraintRows, sumProbRow)) {
+                    Branch child{move(newLP), fixed};
+                    child.depth = br.depth + 1;
+                    skipFixed(child);
+                    maxDepth = max(maxDepth, child.depth);
+
+                    // Primeiro ramo aberto completo: a solução é a deste nó
+                    if (child.depth == order.size()) {
+                        open.push_back(move(child));
+                        return open;
+                    }
+                    if (!checkpointFile.empty())
+                        child.columns = lastValuations;
+                    frontier.push_back(move(child));
+                    ++pushed;
+                }
+                openNodes = frontier.size();
+            }
+        } catch (const Interrupted&) {
+            // O ramo em expansão volta inteiro no lugar dos filhos já gerados
+            if (!checkpointFile.empty()) {
+                for (; pushed > 0; --pushed)
+                    frontier.pop_back();
+                frontier.push_back(move(br));
+                saveCheckpoint(frontier);
             }
+            throw;
         }
+    }
+    return open;
+}
+
+// ----------- Simetrias -----------
+
+// Trocas que preservam cada ψᵢ ordenam as valorações da precificação
+// exaustiva e PB (padrões já não distinguem valorações de mesmo padrão);
+// as que preservam as fórmulas viram geradores sobre as binárias, na ordem
+// dos nomes que explore segue
+void FPSolver::detectSymmetries(const vector<FormulaId>& psiList, const set<string>& binaries) {
+    pricingOrder.clear();
+    binaryGenerators.clear();
+    binaryPosition.clear();
+    if (!symmetryEnabled)
+        return;
 
-        branches = move(next);
+    Symmetries symmetries;
+    {
+        ScopedTimer timer(stats.symmetrySeconds);
+        TraceSpan span("symmetry");
+        symmetries = findSymmetries(store, formulas, psiList, propVarToId, [&] { checkLimits(); });
     }
 
-    if (branches.empty()) {
-        if (verbose) cout << endl;
-        cout << "UNSAT (all branches closed)" << endl;
+    if (!patternPricing)
+        for (const auto& cls : symmetries.pricingClasses)
+            for (size_t j = 0; j + 1 < cls.size(); ++j)
+                pricingOrder.emplace_back(cls[j], cls[j + 1]);
+
+    if (!symmetries.generators.empty()) {
+        size_t position = 0;
+        for (const auto& b : binaries)
+            binaryPosition[b] = position++;
+        for (const auto& generator : symmetries.generators) {
+            BinaryGenerator g;
+            for (const auto& node : generator)
+                g.entries.push_back({binaryPosition.at("b(" + to_string(node.image) + ")"),
+                                     binaryPosition.at("b(" + to_string(node.source) + ")"), node.flip});
+            sort(g.entries.begin(), g.entries.end(),
+                 [](const BinaryGenerator::Entry& a, const BinaryGenerator::Entry& b) { return a.position < b.position; });
+            binaryGenerators.push_back(move(g));
+        }
+    }
+
+    stats.symmetryGenerators = static_cast<int>(binaryGenerators.size());
+    stats.pricingSymmetries = static_cast<int>(pricingOrder.size());
+    if (verbose)
+        log << "[Symmetry] " << symmetries.formulaClasses.size() << " classes of interchangeable variables, "
+            << binaryGenerators.size() << " generators over the binaries, "
+            << pricingOrder.size() << " pricing order pairs"
+            << (symmetries.truncated ? " (search truncated)" : "") << endl;
+}
+
+// A atribuição parcial do ramo não pode ser a menor da sua órbita
+bool FPSolver::symmetricBranch(const map<string, int>& fixed) const {
+    if (binaryGenerators.empty())
         return false;
+
+    vector<signed char> values(binaryPosition.size(), -1);
+    for (const auto& [b, val] : fixed) {
+        auto it = binaryPosition.find(b);
+        if (it != binaryPosition.end())
+            values[it->second] = static_cast<signed char>(val);
+    }
+    return any_of(binaryGenerators.begin(), binaryGenerators.end(),
+                  [&](const BinaryGenerator& g) { return !lexLeaderPossible(g, values); });
+}
+
+// ----------- Checkpoint -----------
+
+namespace {
+
+// FNV-1a de 64 bits, com um separador depois de cada texto
+constexpr uint64_t FNV_OFFSET = 1469598103934665603ULL;
+
+void hashText(uint64_t& hash, const string& text) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    hash ^= 0xff;
+    hash *= 1099511628211ULL;
+}
+
+} // namespace
+
+// Hash das fórmulas normalizadas, das variáveis, das binárias e do
+// oráculo: um checkpoint só vale para a mesma codificação
+uint64_t FPSolver::fingerprint(const set<string>& binaries) const {
+    uint64_t hash = FNV_OFFSET;
+    for (FormulaId f : formulas)
+        hashText(hash, store.toString(f));
+    for (const auto& v : varList)
+        hashText(hash, v);
+    for (const auto& b : binaries)
+        hashText(hash, b);
+    hashText(hash, usePB ? "pb" : patternPricing ? "patterns" : "exhaustive");
+    return hash;
+}
+
+void FPSolver::saveCheckpoint(const deque<Branch>& frontier) {
+    Checkpoint cp;
+    cp.fingerprint = searchFingerprint;
+    cp.nodes = totalNodes;
+    cp.iterations = totalIterations;
+    cp.columns = totalColumns;
+    cp.seconds = resumedSeconds + chrono::duration<double>(chrono::steady_clock::now() - solveStart).count();
+
+    // As valorações repetidas entre ramos são gravadas uma vez
+    map<vector<bool>, int> index;
+    for (const auto& br : frontier) {
+        Checkpoint::Node node;
+        node.fixedBinaries = br.fixedBinaries;
+        for (const auto& valuation : br.columns) {
+            auto [it, inserted] = index.emplace(valuation, static_cast<int>(cp.valuations.size()));
+            if (inserted)
+                cp.valuations.push_back(valuation);
+            node.columns.push_back(it->second);
+        }
+        cp.frontier.push_back(move(node));
+    }
+
+    writeCheckpoint(checkpointFile, cp);
+    log << "[Checkpoint] " << cp.frontier.size() << " open branches, " << cp.valuations.size()
+        << " columns saved to " << checkpointFile << endl;
+}
+
+// Refaz os PLs dos ramos gravados: cada nó é resolvido de novo a partir das
+// suas colunas, sem repetir a geração desde p(0); os que fecham são descartados
+vector<FPSolver::Branch> FPSolver::resumeBranches(const LinearProgram& rootLP, const set<string>& binaries,
+                                                  const vector<FormulaId>& psiList, const vector<int>& xVars,
+                                                  const vector<int>& probConstraintRows, int sumProbRow)
+{
+    string file = move(resumeFile);
+    resumeFile.clear();
+    Checkpoint cp = readCheckpoint(file);
+    if (cp.fingerprint != searchFingerprint)
+        throw runtime_error("Checkpoint " + file + " was written for a different instance or options");
+    for (const auto& valuation : cp.valuations)
+        if (valuation.size() != varList.size())
+            throw runtime_error("Checkpoint " + file + " has valuations of the wrong size");
+
+    totalNodes += cp.nodes;
+    totalIterations += cp.iterations;
+    totalColumns += cp.columns;
+    resumedSeconds = cp.seconds;
+
+    vector<Branch> branches;
+    for (const auto& node : cp.frontier) {
+        auto lp = rootLP.clone();
+        for (const auto& [b, val] : node.fixedBinaries) {
+            if (!binaries.count(b))
+                throw runtime_error("Checkpoint " + file + " fixes unknown binary " + b);
+            lp->addConstraint({{lp->getVarIndex(b), 1.0}}, LinearProgram::EQ, val);
+        }
+
+        vector<vector<bool>> columns;
+        for (int c : node.columns)
+            columns.push_back(cp.valuations[c]);
+        if (isFeasible(psiList, lp->clone(), xVars, probConstraintRows, sumProbRow, columns)) {
+            branches.push_back(Branch{move(lp), node.fixedBinaries});
+            if (!checkpointFile.empty())
+                branches.back().columns = lastValuations;
+        }
+    }
+
+    log << "[Resume] " << branches.size() << " of " << cp.frontier.size() << " branches restored from "
+        << file << " (" << cp.nodes << " nodes, " << fixed << setprecision(1) << cp.seconds
+        << defaultfloat << setprecision(6) << " s in previous runs)" << endl;
+    return branches;
+}
+
+// ----------- Componentes independentes -----------
+
+namespace {
+
+// O que a combinação usa de cada componente resolvido
+struct ComponentOutcome {
+    FPResult result;
+    vector<pair<FormulaId, double>> modalValues;
+    vector<int> valuationVars;          // variável do armazém em cada posição
+    vector<vector<bool>> valuations;
+    vector<double> probabilities;
+    map<string, int> openBranch;
+    bool patternPricing = false;
+};
+
+void addStats(FPStats& total, const FPStats& part) {
+    total.encodeSeconds += part.encodeSeconds;
+    total.presolveSeconds += part.presolveSeconds;
+    total.atomsMerged += part.atomsMerged;
+    total.atomsFixed += part.atomsFixed;
+    total.atomRelations += part.atomRelations;
+    total.symmetrySeconds += part.symmetrySeconds;
+    total.symmetryGenerators += part.symmetryGenerators;
+    total.pricingSymmetries += part.pricingSymmetries;
+    total.nodesSymmetric += part.nodesSymmetric;
+    total.lpSolves += part.lpSolves;
+    total.lpSeconds += part.lpSeconds;
+    total.exhaustivePricings += part.exhaustivePricings;
+    total.exhaustiveSeconds += part.exhaustiveSeconds;
+    total.pbPricings += part.pbPricings;
+    total.pbSeconds += part.pbSeconds;
+    total.patternPricings += part.patternPricings;
+    total.patternSeconds += part.patternSeconds;
+    total.patternNodes += part.patternNodes;
+    total.columnsPooled += part.columnsPooled;
+    total.nodesClosed += part.nodesClosed;
+    total.nodesPruned += part.nodesPruned;
+    total.peakRows = max(total.peakRows, part.peakRows);
+    total.peakCols = max(total.peakCols, part.peakCols);
+}
+
+} // namespace
+
+// Componentes conexos do DAG das fórmulas normalizadas. Com hash-consing,
+// átomos Pψ e variáveis em comum são nós em comum; fórmulas sem nó em comum
+// admitem distribuições escolhidas em separado.
+vector<vector<FormulaId>> FPSolver::findComponents() const {
+    vector<FormulaId> parent(store.size());
+    for (FormulaId id = 0; id < static_cast<FormulaId>(parent.size()); ++id)
+        parent[id] = id;
+    auto find = [&](FormulaId x) {
+        while (parent[x] != x)
+            x = parent[x] = parent[parent[x]];
+        return x;
+    };
+
+    for (FormulaId id : store.reachable(formulas)) {
+        const FormulaNode& n = store[id];
+        if (n.left != NO_FORMULA)
+            parent[find(id)] = find(n.left);
+        if (n.right != NO_FORMULA)
+            parent[find(id)] = find(n.right);
+    }
+
+    map<FormulaId, size_t> index;
+    vector<vector<FormulaId>> components;
+    for (FormulaId f : formulas) {
+        auto [it, inserted] = index.emplace(find(f), components.size());
+        if (inserted)
+            components.emplace_back();
+        components[it->second].push_back(f);
+    }
+    return components;
+}
+
+// Cada componente vai para um FPSolver próprio, em paralelo; o veredito é
+// SAT se todos são SAT, e a distribuição é o produto das distribuições
+bool FPSolver::solveComponents(const vector<vector<FormulaId>>& components) {
+    size_t threads = min<size_t>(components.size(), max(1u, thread::hardware_concurrency()));
+    if (verbose)
+        log << "[Components] " << components.size() << " independent components, solved on "
+            << threads << (threads == 1 ? " thread" : " threads") << endl;
+
+    double remaining = 0.0;
+    if (timeLimit > 0)
+        remaining = max(1e-9, chrono::duration<double>(deadline - chrono::steady_clock::now()).count());
+
+    // O primeiro componente UNSAT, ou erro, interrompe os demais. Os limites
+    // são comuns: o de nós por um contador compartilhado, o de memória porque
+    // a memória residente medida é a do processo
+    atomic<bool> stop{false};
+    atomic<long> nodes{0};
+    atomic<size_t> next{0};
+    vector<ComponentOutcome> outcomes(components.size());
+    exception_ptr error;
+    mutex errorMutex;
+
+    auto worker = [&]() {
+        for (size_t k = next++; k < components.size(); k = next++) {
+            try {
+                // merge num armazém vazio preserva os IDs dos nós e das variáveis
+                FormulaStore local;
+                vector<FormulaId> roots = local.merge(store, components[k]);
+                FPSolver sub(move(local), move(roots), verbose);
+                sub.usePB = usePB;
+                sub.pbSolver = pbSolver;
+                sub.pbArg = pbArg;
+                sub.normalizeEnabled = false;   // já normalizadas
+                sub.presolveEnabled = presolveEnabled;
+                sub.symmetryEnabled = symmetryEnabled;
+                sub.decomposeEnabled = false;
+                sub.cutMode = cutMode;
+                sub.pricingMode = pricingMode;
+                sub.setColumnAging(columnAgeLimit, columnAgeThreshold);
+                sub.setFastMode(fastMode);
+                sub.setLimits(remaining, cancelFlag);
+                sub.componentStop = &stop;
+                sub.componentNodes = &nodes;
+                sub.nodeLimit = nodeLimit;
+                sub.memLimitBytes = memLimitBytes;
+                sub.columnCacheDir = columnCacheDir;
+                sub.seedValuations = seedValuations;
+                sub.lastOpenBranch = lastOpenBranch;
+                if (!dumpDir.empty())
+                    sub.setDumpOptions(dumpDir + "/component_" + to_string(k + 1), dumpLimit);
+                sub.solve();
+
+                ComponentOutcome& out = outcomes[k];
+                out.result = sub.lastResult;
+                if (out.result.status == FPStatus::UNSAT)
+                    stop = true;
+                if (out.result.sat()) {
+                    out.modalValues = sub.lastModalValues;
+                    out.valuationVars = sub.valuationVars;
+                    out.valuations = sub.lastValuations;
+                    out.probabilities = sub.lastProbDistribution;
+                    out.openBranch = sub.lastOpenBranch;
+                    out.patternPricing = sub.patternPricing;
+                }
+            } catch (...) {
+                lock_guard<mutex> lock(errorMutex);
+                if (!error)
+                    error = current_exception();
+                stop = true;
+            }
+        }
+    };
+
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t)
+        workers.emplace_back(worker);
+    for (auto& w : workers)
+        w.join();
+    if (error)
+        rethrow_exception(error);
+
+    patternPricing = false;
+    for (const auto& out : outcomes) {
+        totalNodes += out.result.nodes;
+        totalIterations += out.result.iterations;
+        totalColumns += out.result.columns;
+        addStats(stats, out.result.stats);
+        patternPricing = patternPricing || out.patternPricing;
+    }
+
+    for (size_t k = 0; k < outcomes.size(); ++k)
+        if (outcomes[k].result.status == FPStatus::UNSAT)
+            return finish(FPStatus::UNSAT, "component " + to_string(k + 1) + ": " + outcomes[k].result.reason);
+    for (const auto& out : outcomes)
+        if (out.result.status == FPStatus::UNKNOWN)
+            return finish(FPStatus::UNKNOWN, out.result.reason);
+
+    // Átomos de massa positiva de cada componente, nas posições de varList
+    vector<vector<pair<vector<bool>, double>>> factors;
+    size_t productSize = 1;
+    lastModalValues.clear();
+    map<string, int> openBranch;
+    for (const auto& out : outcomes) {
+        lastModalValues.insert(lastModalValues.end(), out.modalValues.begin(), out.modalValues.end());
+        openBranch.insert(out.openBranch.begin(), out.openBranch.end());
+
+        auto& factor = factors.emplace_back();
+        for (size_t i = 0; i < out.valuations.size(); ++i) {
+            if (out.probabilities[i] <= 0)
+                continue;
+            vector<bool> valuation(varList.size(), false);
+            for (size_t j = 0; j < out.valuationVars.size(); ++j)
+                valuation[propVarToId[out.valuationVars[j]]] = out.valuations[i][j];
+            factor.emplace_back(move(valuation), out.probabilities[i]);
+        }
+        productSize = productSize > maxProductAtoms / max<size_t>(1, factor.size())
+                          ? maxProductAtoms + 1 : productSize * factor.size();
+    }
+
+    auto join = [](vector<bool> a, const vector<bool>& b) {
+        for (size_t j = 0; j < a.size(); ++j)
+            a[j] = a[j] || b[j];
+        return a;
+    };
+
+    vector<pair<vector<bool>, double>> atoms{{vector<bool>(varList.size(), false), 1.0}};
+    if (productSize <= maxProductAtoms) {
+        for (const auto& factor : factors) {
+            vector<pair<vector<bool>, double>> product;
+            for (const auto& [v, p] : atoms)
+                for (const auto& [w, q] : factor)
+                    product.emplace_back(join(v, w), p * q);
+            atoms = move(product);
+        }
+    } else {
+        // Produto grande demais: acoplamento em escada (canto noroeste), que
+        // mantém as marginais com no máximo Σ kᵢ átomos
+        atoms.clear();
+        vector<size_t> pos(factors.size(), 0);
+        vector<double> left;
+        for (const auto& factor : factors)
+            left.push_back(factor[0].second);
+        for (bool done = false; !done;) {
+            double mass = *min_element(left.begin(), left.end());
+            vector<bool> valuation(varList.size(), false);
+            for (size_t c = 0; c < factors.size(); ++c)
+                valuation = join(move(valuation), factors[c][pos[c]].first);
+            atoms.emplace_back(move(valuation), mass);
+            for (size_t c = 0; c < factors.size(); ++c) {
+                left[c] -= mass;
+                if (left[c] > 1e-12)
+                    continue;
+                if (++pos[c] == factors[c].size())
+                    done = true;
+                else
+                    left[c] = factors[c][pos[c]].second;
+            }
+        }
+    }
+
+    lastValuations.clear();
+    lastProbDistribution.clear();
+    for (auto& [v, p] : atoms) {
+        lastValuations.push_back(move(v));
+        lastProbDistribution.push_back(p);
+    }
+
+    rememberSolution(openBranch);
+    return finish(FPStatus::SAT, "open branch found in every component");
+}
+
+// ----------- Cache de colunas -----------
+
+// A chave não depende da ordem dos átomos nem da parte Ł das fórmulas: só
+// do conjunto dos ψ de todos os átomos P, antes da pré-resolução (que só
+// muda as linhas do PL, não as valorações), e da ordem das variáveis
+void FPSolver::loadColumnCache() {
+    cachedColumns.clear();
+    columnCachePath.clear();
+    if (columnCacheDir.empty())
+        return;
+
+    vector<string> psis;
+    for (FormulaId id : store.reachable(formulas))
+        if (store[id].modal && store[id].modalOp() == ModalConnective::P_ATOM)
+            psis.push_back(store.toString(store[id].left));
+    sort(psis.begin(), psis.end());
+
+    columnCacheKey = FNV_OFFSET;
+    for (const auto& psi : psis)
+        hashText(columnCacheKey, psi);
+    hashText(columnCacheKey, "|");
+    for (const auto& v : varList)
+        hashText(columnCacheKey, v);
+
+    columnCachePath = columnCacheFile(columnCacheDir, columnCacheKey);
+    try {
+        cachedColumns = readColumnCache(columnCachePath, columnCacheKey, varList.size());
+    } catch (const runtime_error& e) {
+        log << "[ColumnCache] Ignoring cache: " << e.what() << endl;
+    }
+    if (!cachedColumns.empty())
+        log << "[ColumnCache] " << cachedColumns.size() << " columns loaded from " << columnCachePath << endl;
+}
+
+// As colunas desta execução primeiro; as antigas completam até o limite
+void FPSolver::saveColumnCache() {
+    vector<vector<bool>> merged(usefulColumns.begin(), usefulColumns.end());
+    for (const auto& valuation : cachedColumns)
+        if (!usefulColumns.count(valuation))
+            merged.push_back(valuation);
+    if (merged.size() > maxCachedColumns)
+        merged.resize(maxCachedColumns);
+
+    try {
+        writeColumnCache(columnCachePath, columnCacheKey, varList.size(), merged);
+        if (verbose)
+            log << "  [ColumnCache] " << merged.size() << " columns saved to " << columnCachePath << "\n";
+    } catch (const exception& e) {
+        log << "[ColumnCache] Could not save cache: " << e.what() << endl;
     }
+}
 
-    if (verbose) cout << endl;
-    cout << "SAT (open branch found)" << endl;
+bool FPSolver::finish(FPStatus status, const string& reason) {
+    lastResult = FPResult{};
+    lastResult.status = status;
+    lastResult.reason = reason;
+    if (status != FPStatus::SAT)
+        return false;
 
-    cout << "\n==== MODAL ATOMS VALUATION ====\n";
+    lastResult.variables = varList;
     for (const auto& [id, val] : lastModalValues)
-        cout << id << " = " << val << "\n";
+        lastResult.modalValues.emplace_back(store.toString(id), val);
 
-    cout << "\n==== PROBABILITY DISTRIBUTION ====\n";
     for (size_t i = 0; i < lastProbDistribution.size(); ++i) {
-        size_t w = 0;
-        if (!usePB) {
+        // Na busca exaustiva o rótulo é a própria valoração
+        size_t w = i;
+        if (valuationLabels()) {
+            w = 0;
             for (size_t j = 0; j < varList.size(); ++j)
                 if (lastValuations.at(i).at(j))
-                    w |= (1 << j);
+                    w |= (size_t(1) << j);
         }
-        cout << "p(" << (usePB ? i : w) << ") = " << lastProbDistribution[i] << "   (";
-        for (size_t j = 0; j < varList.size(); ++j)
-            cout << varList[j] << "=" << lastValuations.at(i).at(j) << (j + 1 < varList.size() ? ", " : "");
-        cout << ")\n";
+        lastResult.distribution.push_back({w, lastProbDistribution[i], lastValuations[i]});
     }
+    return true;
+}
 
-    saveOutputToFile();  // escreve no arquivo .out
+// ----------- Certificação exata da solução -----------
 
-    return true;
+bool FPSolver::certifySolution(const vector<FormulaId>& psiList,
+                               const LinearProgram& leafLP,
+                               const vector<int>& probConstraintRows,
+                               int sumProbRow)
+{
+    // PL mestre reduzido: binárias fixadas da folha e só as colunas do
+    // suporte da distribuição (probabilidade positiva)
+    auto lp = leafLP.clone();
+    lp->setExact();
+
+    for (size_t w = 0; w < lastValuations.size(); ++w)
+        if (lastProbDistribution[w] > 0)
+            addValuationColumn(psiList, *lp, probConstraintRows, sumProbRow,
+                               lastValuations[w], "p(" + to_string(w) + ")");
+
+    if (!solveLP(*lp))
+        return false;
+
+    return lp->getObjectiveValueExact() <= 0;
 }
 
 // ----------- Tradução de fórmulas modais -----------
 
-void FPSolver::encodeModalFormula(const ModalFormula& f,
-                                  LinearProgram& lp,
-                                  unordered_map<string, int>& xVars,
-                                  unordered_map<string, int>& bVars) {
+void FPSolver::encodeModalFormulas(LinearProgram& lp, vector<int>& xVars) {
     using M = ModalConnective;
-    string id = f.toString();
-    if (xVars.count(id)) return;
+    xVars.assign(store.size(), -1);
 
-    if (f.op == M::P_ATOM) {
-        xVars[id] = lp.addVariable("x(" + id + ")", 0, 1);
-        return;
-    }
+    // Cada subfórmula compartilhada é codificada uma vez; os filhos vêm antes
+    for (FormulaId id : store.reachable(formulas)) {
+        const FormulaNode& f = store[id];
+        if (!f.modal) continue;
+
+        string suffix = "(" + to_string(id) + ")";
+        if (f.modalOp() == M::P_ATOM) {
+            xVars[id] = lp.addVariable("x" + suffix, 0, 1);
+            if (verbose)
+                log << "  [Encode] x" << suffix << " = " << store.toString(id) << "\n";
+            continue;
+        }
 
-    encodeModalFormula(*f.left, lp, xVars, bVars);
-    int leftX = xVars[f.left->toString()];
+        int leftX = xVars[f.left];
+        int rightX = f.right != NO_FORMULA ? xVars[f.right] : -1;
 
-    int rightX = -1;
-    if (f.right) {
-        encodeModalFormula(*f.right, lp, xVars, bVars);
-        rightX = xVars[f.right->toString()];
-    }
+        int xIdx = lp.addVariable("x" + suffix, 0, 1);
+        xVars[id] = xIdx;
+        if (verbose)
+            log << "  [Encode] x" << suffix << " = " << store.toString(id) << "\n";
 
-    int xIdx = lp.addVariable("x(" + id + ")", 0, 1);
-    xVars[id] = xIdx;
+        int bIdx = -1;
+        if (f.modalOp() != M::NOT) bIdx = lp.addVariable("b" + suffix, 0, 1);
 
-    int bIdx = -1;
-    if (f.op != M::NOT) bVars[id] = bIdx = lp.addVariable("b(" + id + ")", 0, 1);
+        encodeGadget(lp, f.modalOp(), leftX, rightX, xIdx, bIdx);
+    }
+}
 
-    switch (f.op) {
+void FPSolver::encodeGadget(LinearProgram& lp, ModalConnective op, int leftX, int rightX, int xIdx, int bIdx) {
+    using M = ModalConnective;
+    switch (op) {
         case M::NOT:
-            lp.addConstraint({{leftX, -1}, {xIdx, 1}}, LinearProgram::EQ, 1);
+            lp.addConstraint({{leftX, 1}, {xIdx, 1}}, LinearProgram::EQ, 1);
             break;
         case M::OPLUS:
             lp.addConstraint({{bIdx, 1}, {xIdx, -1}}, LinearProgram::LE, 0);
@@ -233,8 +1268,8 @@ void FPSolver::encodeModalFormula(const ModalFormula& f,
         case M::ODOT:
             lp.addConstraint({{xIdx, 1}}, LinearProgram::GE, 0);
             lp.addConstraint({{xIdx, 1}, {bIdx, -1}}, LinearProgram::LE, 0);
-            lp.addConstraint({{leftX, 1}, {rightX, 1}, {xIdx, -1}}, LinearProgram::GE, 1);
-            lp.addConstraint({{leftX, 1}, {rightX, 1}, {bIdx, -1}, {xIdx, -1}}, LinearProgram::LE, 0);
+            lp.addConstraint({{leftX, 1}, {rightX, 1}, {xIdx, -1}}, LinearProgram::LE, 1);
+            lp.addConstraint({{leftX, 1}, {rightX, 1}, {bIdx, -1}, {xIdx, -1}}, LinearProgram::GE, 0);
             break;
         case M::AND:
             lp.addConstraint({{leftX, 1}, {bIdx, -1}, {xIdx, -1}}, LinearProgram::LE, 0);
@@ -264,120 +1299,361 @@ void FPSolver::encodeModalFormula(const ModalFormula& f,
             // throw runtime_error("Operador modal desconhecido.");
             throw runtime_error("Unknown modal operator.");
     }
+
+    cutPool.addGadgetCuts(op, leftX, rightX, xIdx);
 }
 
 // ----------- Avaliação clássica de CPL -----------
 
-double FPSolver::evaluateCPL(const CPLFormula& f, const unordered_map<string, bool>& val) {
+void FPSolver::indexPsiNodes(const vector<FormulaId>& psiList) {
+    psiNodes = store.reachable(psiList);
+    psiSlot.assign(store.size(), -1);
+    for (size_t k = 0; k < psiNodes.size(); ++k)
+        psiSlot[psiNodes[k]] = static_cast<int>(k);
+}
+
+vector<double> FPSolver::evaluatePsi(const vector<FormulaId>& psiList, const vector<bool>& valuation) const {
     using C = CPLConnective;
-    switch (f.op) {
-        case C::VAR:     return val.at(f.var) ? 1.0 : 0.0;
-        case C::NOT:     return 1.0 - evaluateCPL(*f.left, val);
-        case C::AND:     return min(evaluateCPL(*f.left, val), evaluateCPL(*f.right, val));
-        case C::OR:      return max(evaluateCPL(*f.left, val), evaluateCPL(*f.right, val));
-        case C::IMPLIES: return max(1.0 - evaluateCPL(*f.left, val), evaluateCPL(*f.right, val));
-        case C::IFF:
-            return evaluateCPL(*f.left, val) == evaluateCPL(*f.right, val) ? 1.0 : 0.0;
+
+    // Cada subfórmula compartilhada é avaliada uma vez, dos filhos para os pais
+    vector<char> value(psiNodes.size());
+    for (size_t k = 0; k < psiNodes.size(); ++k) {
+        const FormulaNode& f = store[psiNodes[k]];
+        bool l = f.left != NO_FORMULA && value[psiSlot[f.left]];
+        bool r = f.right != NO_FORMULA && value[psiSlot[f.right]];
+
+        switch (f.cplOp()) {
+            case C::VAR:     value[k] = valuation[propVarToId[f.var]]; break;
+            case C::NOT:     value[k] = !l; break;
+            case C::AND:     value[k] = l && r; break;
+            case C::OR:      value[k] = l || r; break;
+            case C::IMPLIES: value[k] = !l || r; break;
+            case C::IFF:     value[k] = l == r; break;
+        }
     }
-    // throw runtime_error("Operador CPL inválido.");
-    throw runtime_error("Invalid CPL operator.");
-}
 
-double FPSolver::evaluateCPL(const CPLFormula& f,
-                             const vector<string>& varList,
-                             const vector<bool>& valuation) {
-    unordered_map<string, bool> val;
-    for (size_t i = 0; i < varList.size(); ++i)
-        val[varList[i]] = valuation[i];
-    return evaluateCPL(f, val);
+    vector<double> values(psiList.size());
+    for (size_t i = 0; i < psiList.size(); ++i)
+        values[i] = value[psiSlot[psiList[i]]] ? 1.0 : 0.0;
+    return values;
 }
 
 // ----------- Viabilidade de restrições -----------
 
-bool FPSolver::isFeasible(const vector<unique_ptr<CPLFormula>>& psiList,
-                          const unordered_map<string, int>& propVarToId,
+FPSolver::Column FPSolver::addValuationColumn(const vector<FormulaId>& psiList,
+                                              LinearProgram& lp,
+                                              const vector<int>& probConstraintRows,
+                                              int sumProbRow,
+                                              const vector<bool>& valuation,
+                                              const string& name)
+{
+    ++totalColumns;
+
+    Column col;
+    col.name = name;
+    col.valuation = valuation;
+    col.psiValues = evaluatePsi(psiList, valuation);
+
+    int pIdx = lp.addVariable(name, 0.0, 1.0);
+
+    for (size_t i = 0; i < psiList.size(); ++i)
+        if (abs(col.psiValues[i]) > 1e-8)
+            lp.addCoefficientToRow(probConstraintRows[i], pIdx, col.psiValues[i]);
+
+    // Linha da soma de probabilidades
+    lp.addCoefficientToRow(sumProbRow, pIdx, 1.0);
+    return col;
+}
+
+void FPSolver::reinsertColumn(LinearProgram& lp,
+                              const vector<int>& probConstraintRows,
+                              int sumProbRow,
+                              const Column& col)
+{
+    int pIdx = lp.addVariable(col.name, 0.0, 1.0);
+    for (size_t i = 0; i < col.psiValues.size(); ++i)
+        if (abs(col.psiValues[i]) > 1e-8)
+            lp.addCoefficientToRow(probConstraintRows[i], pIdx, col.psiValues[i]);
+    lp.addCoefficientToRow(sumProbRow, pIdx, 1.0);
+}
+
+int FPSolver::ageColumns(LinearProgram& lp, vector<Column>& columns, vector<Column>& pool) {
+    vector<double> redCosts = lp.getReducedCosts();
+    vector<int> purge;
+    vector<Column> kept;
+
+    for (auto& col : columns) {
+        int idx = lp.getVarIndex(col.name);
+        if (!lp.isBasic(idx) && redCosts[idx] > columnAgeThreshold)
+            ++col.age;
+        else
+            col.age = 0;
+
+        if (col.age >= columnAgeLimit) {
+            purge.push_back(idx);
+            col.age = 0;
+            pool.push_back(move(col));
+        } else {
+            kept.push_back(move(col));
+        }
+    }
+
+    if (!purge.empty())
+        lp.removeVariables(purge);
+    columns = move(kept);
+    return static_cast<int>(purge.size());
+}
+
+bool FPSolver::repriceColumnPool(LinearProgram& lp,
+                                 const vector<double>& duals,
+                                 const vector<int>& probConstraintRows,
+                                 int sumProbRow,
+                                 vector<Column>& columns,
+                                 vector<Column>& pool)
+{
+    size_t best = pool.size();
+    double bestCost = -pricingTolerance;
+
+    for (size_t k = 0; k < pool.size(); ++k) {
+        double reducedCost = -duals[sumProbRow];
+        for (size_t i = 0; i < pool[k].psiValues.size(); ++i)
+            reducedCost -= duals[probConstraintRows[i]] * pool[k].psiValues[i];
+        if (reducedCost < bestCost) {
+            bestCost = reducedCost;
+            best = k;
+        }
+    }
+
+    if (best == pool.size())
+        return false;
+
+    reinsertColumn(lp, probConstraintRows, sumProbRow, pool[best]);
+    if (verbose)
+        log << "  [Aging] Column " << pool[best].name << " re-added from pool.\n";
+    columns.push_back(move(pool[best]));
+    pool.erase(pool.begin() + best);
+    return true;
+}
+
+bool FPSolver::isFeasible(const vector<FormulaId>& psiList,
                           unique_ptr<LinearProgram> lp,
-                          const unordered_map<string, int>& xVars,
+                          const vector<int>& xVars,
                           const vector<int>& probConstraintRows,
-                          int sumProbRow)
+                          int sumProbRow,
+                          const vector<vector<bool>>& initialColumns)
 {
-    vector<int> pVars;
-    set<vector<bool>> usedValuations;
-    vector<vector<bool>> lastValuationsLocal;
+    set<vector<bool>> usedValuations;   // valorações no PL ou no pool
+    vector<Column> columns;             // colunas p(·) presentes no PL
+    vector<Column> pool;                // fora do PL: envelhecidas ou do cache
+    vector<bool> addedCuts;
+    vector<bool> addedRelations;
     int iter = 1;
+    bool exact = false;
+    double agingObjective = numeric_limits<double>::infinity();    // objetivo no último descarte
+    // Entre componentes o limite de nós vale para a soma deles
+    long nodesUsed = componentNodes ? componentNodes->fetch_add(1, memory_order_relaxed) : totalNodes;
+    if (nodeLimit > 0 && nodesUsed >= nodeLimit)
+        throw Interrupted{"node limit reached"};
+
+    int node = nodeCounter++;
+    ++totalNodes;
+    TraceSpan span("isFeasible", "node", node);
 
-    string name = "p(0)";
-    int pIdx = lp->addVariable(name, 0.0, 1.0);
+    if (fastMode)
+        lp->setTolerances(lpTolerance, lpTolerance);
 
     // Avaliação da valoração 000...0 (tudo falso)
     vector<bool> zeroValuation(varList.size(), false);
+    columns.push_back(addValuationColumn(psiList, *lp, probConstraintRows, sumProbRow, zeroValuation, "p(0)"));
 
-    for (size_t i = 0; i < psiList.size(); ++i) {
-        double val = evaluateCPL(*psiList[i], varList, zeroValuation);
-        if (abs(val) > 1e-8)
-            lp->addCoefficientToRow(probConstraintRows[i], pIdx, val);
+    // Marca valuation 000...0 como usada
+    usedValuations.insert(zeroValuation);
+
+    // Colunas dadas de partida, com os mesmos nomes do oráculo: ordem de
+    // geração (PB e padrões) ou a própria valoração (Fusca)
+    auto columnName = [&](const vector<bool>& valuation) {
+        size_t w = usedValuations.size() - 1;
+        if (valuationLabels()) {
+            w = 0;
+            for (size_t j = 0; j < valuation.size(); ++j)
+                if (valuation[j]) w |= size_t(1) << j;
+        }
+        return "p(" + to_string(w) + ")";
+    };
+    auto addInitialColumn = [&](const vector<bool>& valuation) {
+        if (usedValuations.insert(valuation).second)
+            columns.push_back(addValuationColumn(psiList, *lp, probConstraintRows, sumProbRow,
+                                                 valuation, columnName(valuation)));
+    };
+
+    // Colunas das soluções anteriores (uso incremental), nas variáveis atuais
+    for (const auto& seed : seedValuations) {
+        vector<bool> valuation(varList.size(), false);
+        for (size_t j = 0; j < valuationVars.size(); ++j)
+            valuation[j] = valuationVars[j] < static_cast<int>(seed.size()) && seed[valuationVars[j]];
+        addInitialColumn(valuation);
     }
 
-    // Linha da soma de probabilidades
-    lp->addCoefficientToRow(sumProbRow, pIdx, 1.0);
-    lastValuationsLocal.push_back(zeroValuation);
+    // Colunas gravadas do nó (retomada de checkpoint)
+    for (const auto& valuation : initialColumns)
+        addInitialColumn(valuation);
 
-    // Marca valuation 000...0 como usada
-    usedValuations.insert(zeroValuation);
+    // Colunas de execuções anteriores (cache em disco): começam no pool e
+    // entram pela reprecificação, antes do oráculo, quando melhoram o PL
+    for (const auto& valuation : cachedColumns) {
+        if (!usedValuations.insert(valuation).second)
+            continue;
+        Column col;
+        col.name = columnName(valuation);
+        col.valuation = valuation;
+        col.psiValues = evaluatePsi(psiList, valuation);
+        pool.push_back(move(col));
+    }
+
+    // Suporte da solução do PL: as colunas que o cache guarda
+    auto supportOf = [&](const vector<double>& primal) {
+        vector<vector<bool>> support;
+        if (columnCachePath.empty())
+            return support;
+        for (const auto& col : columns)
+            if (primal[lp->getVarIndex(col.name)] > 1e-9)
+                support.push_back(col.valuation);
+        return support;
+    };
 
     while (true) {
+        checkLimits();
+        ++totalIterations;
+
         if (verbose) {
-            cout << "============== LINEAR PROGRAM ==============" << endl;
-            lp->print(cout);
-            cout << "============================================" << endl;
+            log << "============== LINEAR PROGRAM ==============" << endl;
+            lp->print(log);
+            log << "============================================" << endl;
         }
 
-        bool status = lp->solve();
+        bool status = solveLP(*lp);
         if (!status) {
             if (verbose)
-                cout << "  [isFeasible] Infeasible LP in iteration " << iter << "\n";
+                log << "  [isFeasible] Infeasible LP in iteration " << iter << "\n";
+            ++stats.nodesClosed;
+            dumpNode(*lp, node);
             return false;
         }
 
         double obj = lp->getObjectiveValue();
-            if (verbose)
-                cout << "  [isFeasible] Iter " << iter << ", obj = " << obj << "\n";
+        if (verbose)
+            log << "  [isFeasible] Iter " << iter << ", obj = " << obj << "\n";
+
+        // Em modo exato só o valor racional decide
+        bool zeroObj = exact ? lp->getObjectiveValueExact() <= 0 : obj <= acceptTolerance;
+
+        if (zeroObj && cutMode == CutMode::NODE) {
+            int numCuts = cutPool.separate(*lp, addedCuts);
+            if (numCuts > 0) {
+                if (verbose)
+                    log << "  [Cuts] " << numCuts << " violated gadget facets added.\n";
+                ++iter;
+                continue;
+            }
+        }
 
-        if (obj <= 0) {
+        if (zeroObj) {
             lastModalValues.clear();
             lastProbDistribution.clear();
-            lastValuations = move(lastValuationsLocal);
-
-            for (const auto& [id, idx] : xVars)
-                lastModalValues[id] = lp->getVariableValue(idx);
-
-            int idx, t = 0;
-            for (int w = 0; w < lastValuations.size(); ++w) {
-                while (true) {
-                    try {
-                        idx = lp->getVarIndex("p(" + to_string(t) + ")");
-                        ++t;
-                        break;
-                    }
-                    catch (...) {
-                        ++t;
-                    }
-                }
-                double pVal = lp->getVariableValue(idx);
-                lastProbDistribution.push_back(pVal);
+            lastValuations.clear();
+
+            vector<double> primal = lp->getPrimal();
+            for (FormulaId id = 0; id < static_cast<FormulaId>(xVars.size()); ++id)
+                if (xVars[id] >= 0)
+                    lastModalValues.emplace_back(id, primal[xVars[id]]);
+
+            for (const auto& col : columns) {
+                lastValuations.push_back(col.valuation);
+                lastProbDistribution.push_back(primal[lp->getVarIndex(col.name)]);
             }
+            for (auto& valuation : supportOf(primal))
+                usefulColumns.insert(move(valuation));
 
+            dumpNode(*lp, node);
             return true;  // Ótimo viável com custo 0
         }
 
+        // Relações entre os átomos P: toda distribuição as satisfaz, então
+        // só um ponto com artificiais positivas pode violá-las
+        int numRelations = relationPool.size() > 0 ? relationPool.separate(*lp, addedRelations) : 0;
+        if (numRelations > 0) {
+            if (verbose)
+                log << "  [Presolve] " << numRelations << " violated atom relations added.\n";
+            ++iter;
+            continue;
+        }
+
+        // Remover colunas descarta a solução guardada no SoPlex: os duais e
+        // o suporte da solução são lidos antes do envelhecimento
+        vector<double> duals;
+        if (!exact)
+            duals = lp->getDuals();
+        vector<vector<bool>> support = supportOf(lp->getPrimal());
+
+        // Envelhecimento: por Carathéodory basta manter as colunas da base;
+        // as que ficam fora dela com custo reduzido alto vão para o pool.
+        // Num patamar degenerado o pool devolveria as mesmas colunas ao PL
+        // indefinidamente: após um descarte, só envelhece de novo quando o
+        // objetivo cai estritamente.
+        if (!exact && columnAgeLimit > 0 && obj < agingObjective - lpTolerance) {
+            int purged = ageColumns(*lp, columns, pool);
+            stats.columnsPooled += purged;
+            if (purged > 0) {
+                agingObjective = obj;
+                if (verbose)
+                    log << "  [Aging] " << purged << " columns moved to pool.\n";
+            }
+        }
+
+        // O pool é reprecificado antes do oráculo, que ignora as valorações já usadas
+        if (!exact && !pool.empty() &&
+            repriceColumnPool(*lp, duals, probConstraintRows, sumProbRow, columns, pool)) {
+            ++iter;
+            continue;
+        }
+
+        // Em modo exato as colunas do pool voltam ao PL, para a precificação exata
+        if (exact && !pool.empty()) {
+            for (auto& col : pool) {
+                reinsertColumn(*lp, probConstraintRows, sumProbRow, col);
+                columns.push_back(move(col));
+            }
+            pool.clear();
+            ++iter;
+            continue;
+        }
+
         bool added = addNewProbabilisticCoherenceConstraint(
-            psiList, propVarToId, *lp, xVars, probConstraintRows,
-            sumProbRow, usedValuations, lastValuationsLocal
+            psiList, *lp, duals, probConstraintRows,
+            sumProbRow, usedValuations, columns, exact
         );
 
         if (!added) {
+            // Poda rente à tolerância: o oráculo pode ter deixado passar uma
+            // coluna com custo reduzido até 'gap', e um objetivo da ordem do
+            // ruído de ponto flutuante não prova a inviabilidade; em qualquer
+            // modo, o nó é refeito em modo exato antes da poda
+            double gap = usePB ? (0.5 * (psiList.size() + 1) + 1.0) / pbScale : pricingTolerance;
+            if (!exact && obj <= gap + 10 * lpTolerance) {
+                if (verbose)
+                    log << "  [Certify] Borderline prune (obj = " << obj << "), re-solving node exactly.\n";
+                lp->setExact();
+                exact = true;
+                ++iter;
+                continue;
+            }
+
             if (verbose)
-                cout << "  [isFeasible] No valuations remaining.\n";
+                log << "  [isFeasible] No valuations remaining.\n";
+            ++stats.nodesPruned;
+            bestObjective = min(bestObjective, obj);
+            usefulColumns.insert(support.begin(), support.end());
+            dumpNode(*lp, node);
             return false;
         }
 
@@ -386,58 +1662,70 @@ bool FPSolver::isFeasible(const vector<unique_ptr<CPLFormula>>& psiList,
 }
 
 bool FPSolver::addNewProbabilisticCoherenceConstraint(
-    const vector<unique_ptr<CPLFormula>>& psiList,
-    const unordered_map<string, int>& propVarToId,
+    const vector<FormulaId>& psiList,
     LinearProgram& lp,
-    const unordered_map<string, int>& xVars,
+    const vector<double>& duals,
     const vector<int>& probConstraintRows,
     int sumProbRow,
     set<vector<bool>>& usedValuations,
-    vector<vector<bool>>& lastValuationsLocal)
+    vector<Column>& columns,
+    bool exact)
 {
-    int n = varList.size();
-    int total = 1 << n;
-
-    // Pega os multiplicadores simplex da solução corrente
-    vector<double> duals = lp.getDuals();
-
     // Calcula os coeficientes da inequação de custo reduzido: ∑ dualᵢ·ψᵢ(w) + dual_soma
-    vector<double> coeffs(n, 0.0);  // uma variável por posição booleana
-    vector<double> weights;        // coeficientes dos ψᵢ
+    vector<double> weights;           // coeficientes dos ψᵢ
+    vector<mpq_class> exactWeights;   // idem, em modo exato
+
+    if (exact) {
+        vector<mpq_class> exactDuals = lp.getDualsExact();
+        for (size_t i = 0; i < psiList.size(); ++i)
+            exactWeights.push_back(exactDuals[probConstraintRows[i]]);
+        exactWeights.push_back(exactDuals[sumProbRow]);
+    } else {
+        // Multiplicadores simplex da solução corrente
+        for (size_t i = 0; i < psiList.size(); ++i)
+            weights.push_back(duals[probConstraintRows[i]]);
+        weights.push_back(duals[sumProbRow]); // soma total: +1 sempre
+    }
 
-    for (size_t i = 0; i < psiList.size(); ++i)
-        weights.push_back(duals[probConstraintRows[i]]);
-    weights.push_back(duals[sumProbRow]); // soma total: +1 sempre
+    // Coeficientes inteiros: escala fixa, ou o mmc dos denominadores em modo exato
+    vector<mpz_class> coeffs;
+    if (exact) {
+        mpz_class scale = 1;
+        for (const auto& q : exactWeights)
+            mpz_lcm(scale.get_mpz_t(), scale.get_mpz_t(), q.get_den_mpz_t());
+        for (const auto& q : exactWeights)
+            coeffs.push_back(q.get_num() * (scale / q.get_den()));
+    } else {
+        for (double d : weights)
+            coeffs.push_back(mpz_class(static_cast<long>(round(d * pbScale))));
+    }
+
+    // Problema de precificação em OPB, também na busca exaustiva
+    if (!dumpDir.empty() && dumpedPricing < dumpLimit) {
+        filesystem::path opb = filesystem::path(dumpDir) / ("pricing_" + to_string(dumpedPricing++) + ".opb");
+        writeOPBFile(psiList, coeffs, usedValuations, opb.string());
+    }
 
     if (usePB) {
         // Tenta usar PB-SAT
-        optional<vector<bool>> valuationPB =
-            findValuationPB(psiList, weights, usedValuations);
+        ++stats.pbPricings;
+        optional<vector<bool>> valuationPB;
+        {
+            ScopedTimer timer(stats.pbSeconds);
+            TraceSpan span("findValuationPB");
+            valuationPB = findValuationPB(psiList, coeffs, usedValuations);
+        }
 
         if (valuationPB.has_value()) {
             const auto& valuation = *valuationPB;
             usedValuations.insert(valuation);
-            lastValuationsLocal.push_back(valuation);
 
             // Gera coluna correspondente
-            vector<pair<int, double>> column;
-
-            for (size_t i = 0; i < psiList.size(); ++i) {
-                double val = evaluateCPL(*psiList[i], varList, valuation);
-                if (abs(val) > 1e-8)
-                    column.emplace_back(probConstraintRows[i], val);
-            }
-
-            column.emplace_back(sumProbRow, 1.0);  // linha da soma
-
             string name = "p(" + to_string(usedValuations.size()-1) + ")";
-            int pIdx = lp.addVariable(name, 0.0, 1.0);
-            for (const auto& [rowIdx, coeff] : column)
-                lp.addCoefficientToRow(rowIdx, pIdx, coeff);
+            columns.push_back(addValuationColumn(psiList, lp, probConstraintRows, sumProbRow, valuation, name));
 
             if (verbose)
-//                cout << "  [PB-SAT] Coluna adicionada via PB solver.\n";
-                cout << "  [PB-SAT] Column added via PB solver.\n";
+                log << "  [PB-SAT] Column added via PB solver.\n";
             return true;
         }
         else {
@@ -445,8 +1733,43 @@ bool FPSolver::addNewProbabilisticCoherenceConstraint(
         }
     }
 
-    // Fusca: busca completa por custo reduzido ≤ 0
+    if (patternPricing) {
+        ++stats.patternPricings;
+        optional<vector<bool>> valuation;
+        {
+            ScopedTimer timer(stats.patternSeconds);
+            TraceSpan span("pricing.patterns");
+            valuation = findValuationPatterns(psiList, weights, exactWeights, usedValuations, exact);
+        }
+        if (!valuation)
+            return false;
+
+        usedValuations.insert(*valuation);
+        string name = "p(" + to_string(usedValuations.size()-1) + ")";
+        columns.push_back(addValuationColumn(psiList, lp, probConstraintRows, sumProbRow, *valuation, name));
+        if (verbose)
+            log << "  [Patterns] Column added with reduced cost < 0.\n";
+        return true;
+    }
+
+    // Fusca: busca completa por custo reduzido < 0. As valorações já no PL
+    // têm custo reduzido ≥ 0 no ótimo; as demais são reavaliadas a cada
+    // iteração, pois os duais mudam.
+    ++stats.exhaustivePricings;
+    ScopedTimer timer(stats.exhaustiveSeconds);
+    TraceSpan span("pricing.exhaustive");
+    int n = varList.size();
+    int total = 1 << n;
     for (int w = 0; w < total; ++w) {
+        if ((w & 0xFFF) == 0)
+            checkLimits();
+
+        // Só a valoração canônica pelas trocas que preservam os ψᵢ
+        if (any_of(pricingOrder.begin(), pricingOrder.end(), [&](const pair<int, int>& pq) {
+                return ((w >> pq.first) & 1) > ((w >> pq.second) & 1);
+            }))
+            continue;
+
         vector<bool> valuation(n);
         for (int i = 0; i < n; ++i)
             valuation[i] = (w >> i) & 1;
@@ -454,37 +1777,36 @@ bool FPSolver::addNewProbabilisticCoherenceConstraint(
         if (usedValuations.count(valuation))
             continue;
 
-        usedValuations.insert(valuation);
-
-        vector<pair<int, double>> column;
-
-        for (size_t i = 0; i < psiList.size(); ++i) {
-            double val = evaluateCPL(*psiList[i], varList, valuation);
-            if (abs(val) > 1e-8)
-                column.emplace_back(probConstraintRows[i], val);
+        vector<double> values = evaluatePsi(psiList, valuation);
+
+        bool improving;
+        double reducedCost;
+
+        if (exact) {
+            mpq_class rc = -exactWeights.back();
+            for (size_t i = 0; i < psiList.size(); ++i)
+                if (values[i] > 0.5) rc -= exactWeights[i];
+            improving = rc < 0;
+            reducedCost = rc.get_d();
+        } else {
+            reducedCost = -weights.back();
+            for (size_t i = 0; i < psiList.size(); ++i)
+                reducedCost -= weights[i] * values[i];
+            improving = reducedCost < -pricingTolerance;
         }
 
-        column.emplace_back(sumProbRow, 1.0);  // soma
-
-        double reducedCost = 0.0;
-        for (const auto& [rowIdx, coeff] : column)
-            reducedCost -= duals[rowIdx] * coeff;
-
         if (verbose) {
-            cout << "Valuation: ";
-            for (bool b : valuation) cout << b;
-            cout << ", reduced cost: " << reducedCost << "\n";
+            log << "Valuation: ";
+            for (bool b : valuation) log << b;
+            log << ", reduced cost: " << reducedCost << "\n";
         }
 
-        if (reducedCost < 0) {
-            lastValuationsLocal.push_back(valuation);
+        if (improving) {
+            usedValuations.insert(valuation);
             string name = "p(" + to_string(w) + ")";
-            int pIdx = lp.addVariable(name, 0.0, 1.0);
-            for (const auto& [rowIdx, coeff] : column)
-                lp.addCoefficientToRow(rowIdx, pIdx, coeff);
+            columns.push_back(addValuationColumn(psiList, lp, probConstraintRows, sumProbRow, valuation, name));
             if (verbose)
-//                cout << "  [Fusca] Coluna adicionada com custo reduzido ≤ 0.\n";
-                cout << "  [Fusca] Column added with reduced cost ≤ 0.\n";
+                log << "  [Fusca] Column added with reduced cost ≤ 0.\n";
             return true;
         }
     }
@@ -492,10 +1814,74 @@ bool FPSolver::addNewProbabilisticCoherenceConstraint(
     return false;  // Nenhuma coluna encontrada */
 }
 
+// ----------- Geração de colunas por padrões dos átomos P -----------
+
+optional<vector<bool>> FPSolver::findValuationPatterns(
+    const vector<FormulaId>& psiList,
+    const vector<double>& weights,
+    const vector<mpq_class>& exactWeights,
+    const set<vector<bool>>& usedValuations,
+    bool exact)
+{
+    size_t m = psiList.size();
+    vector<double> d(m + 1);
+    for (size_t i = 0; i <= m; ++i)
+        d[i] = exact ? exactWeights[i].get_d() : weights[i];
+
+    // Padrões já representados por colunas do nó
+    set<vector<bool>> usedPatterns;
+    for (const auto& valuation : usedValuations) {
+        vector<double> values = evaluatePsi(psiList, valuation);
+        vector<bool> pattern(m);
+        for (size_t i = 0; i < m; ++i)
+            pattern[i] = values[i] > 0.5;
+        usedPatterns.insert(move(pattern));
+    }
+
+    // O custo reduzido -d₀ - Σ dᵢ·ψᵢ é mínimo com ψᵢ = [dᵢ > 0], e inverter
+    // o átomo i custa |dᵢ|
+    vector<bool> preferred(m);
+    vector<double> cost(m);
+    double minCost = -d[m];
+    for (size_t i = 0; i < m; ++i) {
+        preferred[i] = d[i] > 0;
+        cost[i] = fabs(d[i]);
+        if (preferred[i])
+            minCost -= d[i];
+    }
+
+    // Padrão novo com custo reduzido negativo; em modo exato a poda é
+    // aproximada e a decisão, exata
+    auto accept = [&](const vector<bool>& pattern) {
+        if (usedPatterns.count(pattern))
+            return false;
+        if (exact) {
+            mpq_class rc = -exactWeights[m];
+            for (size_t i = 0; i < m; ++i)
+                if (pattern[i]) rc -= exactWeights[i];
+            if (rc >= 0)
+                return false;
+        }
+        if (verbose) {
+            log << "Pattern: ";
+            for (bool b : pattern) log << b;
+            log << "\n";
+        }
+        return true;
+    };
+
+    size_t nodesBefore = patternOracle->searchNodes();
+    optional<vector<bool>> found = patternOracle->search(preferred, cost, minCost,
+                                                         exact ? 1e-9 : -pricingTolerance,
+                                                         accept, [&] { checkLimits(); });
+    stats.patternNodes += static_cast<long>(patternOracle->searchNodes() - nodesBefore);
+    return found;
+}
+
 // ----------- Geração de colunas via PB-SAT -----------
 
-void FPSolver::writeOPBFile(const vector<unique_ptr<CPLFormula>>& psiList,
-                            const vector<double>& duals,
+void FPSolver::writeOPBFile(const vector<FormulaId>& psiList,
+                            const vector<mpz_class>& coeffs,
                             const set<vector<bool>>& usedValuations,
                             const string& filename)
 {
@@ -504,73 +1890,54 @@ void FPSolver::writeOPBFile(const vector<unique_ptr<CPLFormula>>& psiList,
         throw runtime_error("Error opening writting file: " + filename);
 
     int auxVarCounter = varList.size();  // x0, x1, ..., xn-1 já existem
-    vector<string> yVars;      // nomes das vars auxiliares para ψ_i
-
-    auto newVar = [&]() -> string {
-        return "x" + to_string(auxVarCounter++);
-    };
-
-    function<void(const CPLFormula&, string&, ostream&)> encodeFormula;
+    vector<string> nodeVar(psiNodes.size());  // variável PB de cada subfórmula
 
-    encodeFormula = [&](const CPLFormula& f, string& outVar, ostream& os) {
+    // Cada subfórmula compartilhada ganha uma única variável auxiliar,
+    // definida depois das variáveis dos seus filhos
+    for (size_t k = 0; k < psiNodes.size(); ++k) {
         using C = CPLConnective;
+        const FormulaNode& f = store[psiNodes[k]];
 
-        if (f.op == C::VAR) {
-            outVar = "x" + to_string(
-                distance(varList.begin(), find(varList.begin(), varList.end(), f.var))
-            );
-            return;
+        if (f.cplOp() == C::VAR) {
+            nodeVar[k] = "x" + to_string(propVarToId[f.var]);
+            continue;
         }
 
-        string l, r, y = newVar();
+        string y = "x" + to_string(auxVarCounter++);
+        const string& l = nodeVar[psiSlot[f.left]];
+        const string r = f.right != NO_FORMULA ? nodeVar[psiSlot[f.right]] : "";
+        nodeVar[k] = y;
 
-        if (f.left)
-            encodeFormula(*f.left, l, os);
-        if (f.right)
-            encodeFormula(*f.right, r, os);
-
-        switch (f.op) {
+        switch (f.cplOp()) {
             case C::NOT:
-                outVar = y;
-                os << "+1*" << l << " +1*" << y << " >= 1;\n";
-                os << "-1*" << l << " -1*" << y << " >= -1;\n";
+                out << "+1*" << l << " +1*" << y << " >= 1;\n";
+                out << "-1*" << l << " -1*" << y << " >= -1;\n";
                 break;
             case C::AND:
-                outVar = y;
-                os << "+1*" << l << " -1*" << y << " >= 0;\n";
-                os << "+1*" << r << " -1*" << y << " >= 0;\n";
-                os << "-1*" << l << " -1*" << r << " +1*" << y << " >= -1;\n";
+                out << "+1*" << l << " -1*" << y << " >= 0;\n";
+                out << "+1*" << r << " -1*" << y << " >= 0;\n";
+                out << "-1*" << l << " -1*" << r << " +1*" << y << " >= -1;\n";
                 break;
             case C::OR:
-                outVar = y;
-                os << "-1*" << l << " +1*" << y << " >= 0;\n";
-                os << "-1*" << r << " +1*" << y << " >= 0;\n";
-                os << "+1*" << l << " +1*" << r << "-1*" << y << " >= 0;\n";
+                out << "-1*" << l << " +1*" << y << " >= 0;\n";
+                out << "-1*" << r << " +1*" << y << " >= 0;\n";
+                out << "+1*" << l << " +1*" << r << " -1*" << y << " >= 0;\n";
                 break;
             case C::IMPLIES:
-                outVar = y;
-                os << "-1*" << r << " +1*" << y << " >= 0;\n";
-                os << "+1*" << l << " +1*" << y << " >= 1;\n";
-                os << "-1*" << l << " +1*" << r << " -1*" << y << " >= -1;\n";
+                out << "-1*" << r << " +1*" << y << " >= 0;\n";
+                out << "+1*" << l << " +1*" << y << " >= 1;\n";
+                out << "-1*" << l << " +1*" << r << " -1*" << y << " >= -1;\n";
                 break;
             case C::IFF:
-                outVar = y;
-                os << "-1*" << y << " -1*" << l << " +1*" << r << " >= -1\n";
-                os << "-1*" << y << " +1*" << l << " -1*" << r << " >= -1\n";
-                os << "-1*" << l << " -1*" << r << " +1*" << y << " >= -1\n";
-                os << "+1*" << l << " +1*" << r << " +1*" << y << " >= 1\n";
+                out << "-1*" << y << " -1*" << l << " +1*" << r << " >= -1;\n";
+                out << "-1*" << y << " +1*" << l << " -1*" << r << " >= -1;\n";
+                out << "-1*" << l << " -1*" << r << " +1*" << y << " >= -1;\n";
+                out << "+1*" << l << " +1*" << r << " +1*" << y << " >= 1;\n";
                 break;
             default:
 //                throw runtime_error("Conectivo CPL não suportado.");
                 throw runtime_error("Unsupported CPL operator.");
         }
-    };
-
-    // Codificação das fórmulas ψ_i
-    for (size_t i = 0; i < psiList.size(); ++i) {
-        string y;
-        encodeFormula(*psiList[i], y, out);
-        yVars.push_back(y);
     }
 
     // Não gerar valorações já usadas
@@ -590,28 +1957,35 @@ void FPSolver::writeOPBFile(const vector<unique_ptr<CPLFormula>>& psiList,
         out << ">= " << rhs << ";\n";
     }
 
-    // Restrição de custo reduzido: sum d_i * y_i + d_sum >= 1
+    // Valorações canônicas pelas trocas de variáveis que preservam os ψᵢ
+    if (!pricingOrder.empty())
+        out << "* Symmetry breaking\n";
+    for (const auto& [p, q] : pricingOrder)
+        out << "-1*x" << p << " +1*x" << q << " >= 0;\n";
+
+    // Restrição de custo reduzido: sum d_i * y_i + d_sum >= 1 (duais já escalados para inteiros)
     out << "* Reduced-cost inequality\n";
-    for (size_t i = 0; i < yVars.size(); ++i) {
-        long coeff = static_cast<long>(round(duals[i] * 1e6));  // escala para inteiros
+    for (size_t i = 0; i < psiList.size(); ++i) {
+        const mpz_class& coeff = coeffs[i];
         if (coeff == 0) continue;
-        out << (coeff > 0 ? "+" : "") << coeff << "*" << yVars[i] << " ";
+        out << (coeff > 0 ? "+" : "") << coeff << "*" << nodeVar[psiSlot[psiList[i]]] << " ";
     }
 
-    long dSum = static_cast<long>(round(duals.back() * 1e6));
-    out << ">= " << 1-dSum << ";\n";
+    mpz_class rhs = 1 - coeffs.back();
+    out << ">= " << rhs << ";\n";
 }
 
 optional<vector<bool>> FPSolver::findValuationPB(
-    const vector<unique_ptr<CPLFormula>>& psiList,
-    const vector<double>& coeffs,
+    const vector<FormulaId>& psiList,
+    const vector<mpz_class>& coeffs,
     const set<vector<bool>>& usedValuations)
 {
-    filesystem::path inPath(inputFilename);
-    filesystem::path parent = inPath.parent_path();
-    string stem = inPath.stem().string();
-    filesystem::path opbFilename = parent / ("pb_input_"  + stem + ".opb");
-    filesystem::path tmpOutput  = parent / ("pb_output_" + stem + ".txt");
+    // Nomes únicos por processo e chamada: vários solvers podem rodar juntos
+    static atomic<unsigned long> pbCalls{0};
+    string tag = to_string(getpid()) + "_" + to_string(pbCalls++);
+    filesystem::path tmpDir = filesystem::temp_directory_path();
+    filesystem::path opbFilename = tmpDir / ("fplsol_pb_input_"  + tag + ".opb");
+    filesystem::path tmpOutput  = tmpDir / ("fplsol_pb_output_" + tag + ".txt");
 
     writeOPBFile(psiList, coeffs, usedValuations, opbFilename);
     string command = pbSolver;
@@ -642,47 +2016,14 @@ optional<vector<bool>> FPSolver::findValuationPB(
             }
             found = true;
         } else if (line == "s UNSATISFIABLE") {
-            command = "rm " + opbFilename.string() + " " + tmpOutput.string();
-            system(command.c_str());
-            return nullopt;
+            found = false;
+            break;
         }
     }
 
-    command = "rm " + opbFilename.string() + " " + tmpOutput.string();
-    system(command.c_str());
+    in.close();
+    filesystem::remove(opbFilename);
+    filesystem::remove(tmpOutput);
 
     return found ? optional<vector<bool>>(valuation) : nullopt;
 }
-
-// ----------- Salva solução em arquivo -----------
-
-void FPSolver::saveOutputToFile() {
-    string outName = inputFilename.substr(0, inputFilename.find_last_of('.')) + ".out";
-    ofstream out(outName);
-    if (!out) {
-        cerr << "Error opening output file: " << outName << "\n";
-        return;
-    }
-
-    out << "======= MODAL ATOMS VALUATION ====\n";
-    for (const auto& [id, val] : lastModalValues)
-        out << id << " = " << val << "\n";
-
-    out << "\n==== PROBABILITY DISTRIBUTION ====\n";
-    for (size_t i = 0; i < lastProbDistribution.size(); ++i) {
-        size_t w = 0;
-        if (!usePB) {
-            for (size_t j = 0; j < varList.size(); ++j)
-                if (lastValuations.at(i).at(j))
-                    w |= (1 << j);
-        }
-        out << "p(" << (usePB ? i : w) << ") = " << lastProbDistribution[i] << "   (";
-        for (size_t j = 0; j < varList.size(); ++j)
-            out << varList[j] << "=" << (lastValuations[i][j] ? "1" : "0") << (j + 1 < varList.size() ? ", " : "");
-        out << ")\n";
-    }
-
-    out.close();
-    cout << "\nResult saved in: " << outName << "\n";
-}
-
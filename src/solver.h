@@ -3,41 +3,234 @@
 
 #include "formula.h"
 #include "linear_program.h"
+#include "cuts.h"
+#include "fplsol.h"
+#include "pattern_oracle.h"
+#include "symmetry.h"
 #include <vector>
 #include <unordered_map>
 #include <string>
 #include <memory>
 #include <map>
+#include <set>
 #include <optional>
+#include <ostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 
 class FPSolver {
 public:
     // Construtor
-    explicit FPSolver(std::vector<ModalFormula> formulas, std::string inputFilename, bool verbose);
+    FPSolver(FormulaStore store, std::vector<FormulaId> formulas, bool verbose);
+
+    // Destino das mensagens de progresso e do modo verboso (nullptr: nenhum)
+    void setLog(std::ostream* out);
 
     // Configura o PB solver
     void setPBOptions(bool usePB, const std::string& pbSolverPath, const std::string& pbArguments);
 
+    // Normalização AC e simplificação das fórmulas antes da codificação
+    void setNormalize(bool enabled);
+
+    // Pré-resolução clássica dos átomos P antes do PL raiz: funde os
+    // equivalentes e fixa os insatisfazíveis e os válidos. Com 'relations',
+    // as implicações, exclusões e coberturas entre eles entram nos nós cuja
+    // solução as viola; nunca mudam o veredito de um nó e, nos satisfazíveis,
+    // só atrasam a Fase I
+    void setPresolve(bool enabled, bool relations = false) {
+        presolveEnabled = enabled;
+        presolveRelations = relations;
+    }
+
+    // Simetrias por trocas de variáveis: valorações canônicas na
+    // precificação exaustiva e PB, e poda lexicográfica das binárias
+    void setSymmetry(bool enabled) { symmetryEnabled = enabled; }
+
+    // Configura os cortes dos gadgets Ł
+    void setCutMode(CutMode mode) { cutMode = mode; }
+
+    // Oráculo de precificação quando o solver PB não é usado
+    void setPricingMode(PricingMode mode) { pricingMode = mode; }
+
+    // Envelhecimento das colunas p(·): após 'limit' iterações fora da base
+    // com custo reduzido acima de 'threshold' a coluna vai para o pool
+    void setColumnAging(int limit, double threshold = 1e-3);
+
+    // Modo rápido: tolerâncias folgadas e certificação exata do veredito
+    void setFastMode(bool fast);
+
+    // Salva PLs dos nós (LP/MPS) e problemas de precificação (OPB) em 'dir'
+    void setDumpOptions(const std::string& dir, int limit);
+
+    // Interrompe solve após 'timeLimit' segundos (0: sem limite) ou quando
+    // *cancel vira true; o veredito fica UNKNOWN
+    void setLimits(double timeLimit, const std::atomic<bool>* cancel = nullptr);
+
+    // Limites de nós (PLs de nó resolvidos) e de memória residente em MB
+    // (0: sem limite), também com veredito UNKNOWN. Perto do limite de
+    // memória a busca passa de largura para profundidade.
+    void setResourceLimits(long nodeLimit, double memLimitMB);
+
+    // Linha de progresso em 'log' a cada 'seconds' (0: nenhuma)
+    void setProgressInterval(double seconds);
+
+    // Grava o estado da busca (ramos abertos, suas colunas e os contadores)
+    // em 'file' a cada 'interval' segundos e ao ser interrompida
+    void setCheckpoint(const std::string& file, double interval);
+
+    // A próxima chamada de solve continua a busca gravada em 'file'
+    void setResume(const std::string& file);
+
+    // Cache de colunas entre execuções em 'dir' ("" desliga): as colunas
+    // que sustentaram os PLs de nó são gravadas ao fim de solve e começam
+    // no pool de colunas dos nós das execuções com os mesmos átomos P
+    void setColumnCache(const std::string& dir);
+
+    // Grupos de fórmulas sem átomo P nem variável em comum são resolvidos
+    // em paralelo, cada um com suas próprias valorações (padrão: ligado;
+    // desligado com checkpoint ou retomada)
+    void setDecompose(bool enabled);
+
+    // Uso incremental: fórmulas acrescentadas em escopos; solve reaproveita
+    // as colunas e o último ramo aberto das chamadas anteriores
+    FormulaId addFormula(std::string_view text);
+    void addFormula(FormulaId formula);
+    void push();
+    void pop();
+    size_t numFormulas() const { return inputFormulas.size(); }
+    FormulaStore& formulaStore() { return store; }
+
     // Executa o algoritmo de decisão
     bool solve();
 
+    // Veredito e solução da última chamada de solve
+    const FPResult& result() const { return lastResult; }
+
 private:
-    // Nome do arquivo de entrada
-    std::string inputFilename;
+    // Micro-benchmarks dos núcleos internos (bench/bench.cpp)
+    friend struct SolverBench;
+
+    // Mensagens: sem destino, o stream descarta tudo
+    std::ostream log{nullptr};
 
     // Configurações do PB solver
     bool usePB = true;
     std::string pbSolver = "minisat+";
     std::string pbArg = "";
 
+    // Precificação por padrões dos átomos P (ver setPricingMode); decidida
+    // em search, com o oráculo dos ψᵢ da busca corrente
+    static constexpr size_t maxExhaustiveVars = 20;
+    PricingMode pricingMode = PricingMode::AUTO;
+    bool patternPricing = false;
+    std::unique_ptr<PatternOracle> patternOracle;
+
     // Verborse mode
     bool verbose = false;
 
-    // Fórmulas de entrada
-    std::vector<ModalFormula> formulas;
+    // Tolerâncias numéricas (ver setFastMode)
+    bool fastMode = false;
+    double acceptTolerance = 0.0;   // obj ≤ tol aceita o nó
+    double pricingTolerance = 0.0;  // custo reduzido < -tol gera coluna
+    double pbScale = 1e6;           // escala inteira dos duais no OPB
+    double lpTolerance = 1e-6;      // feastol/opttol do SoPlex
+
+    // Arquivos para análise offline (ver setDumpOptions)
+    std::string dumpDir;
+    int dumpLimit = 16;
+    int dumpedPricing = 0;
+    int nodeCounter = 0;
+
+    // Limites da resolução (ver setLimits)
+    double timeLimit = 0.0;
+    const std::atomic<bool>* cancelFlag = nullptr;
+    std::chrono::steady_clock::time_point deadline;
+    long nodeLimit = 0;
+    size_t memLimitBytes = 0;
+    unsigned limitChecks = 0;
+    bool lowMemory = false;         // busca em profundidade
+
+    // Progresso (ver setProgressInterval)
+    double progressInterval = 0.0;
+    std::chrono::steady_clock::time_point solveStart, nextProgress;
+    size_t openNodes = 0;           // ramos na fronteira
+    size_t maxDepth = 0;            // binárias fixadas no ramo mais fundo
+    size_t numBinaries = 0;
+    double bestObjective = 0.0;     // menor objetivo da Fase I entre os nós podados
 
-    // Mapeamento de variáveis proposicionais para IDs numéricos
-    std::unordered_map<std::string, int> propVarToId;
+    // Checkpoint e retomada (ver setCheckpoint e setResume)
+    std::string checkpointFile;
+    double checkpointInterval = 300.0;
+    std::chrono::steady_clock::time_point nextCheckpoint;
+    std::string resumeFile;
+    std::uint64_t searchFingerprint = 0;
+    double resumedSeconds = 0.0;    // tempo das execuções anteriores
+
+    // Cache de colunas entre execuções (ver setColumnCache)
+    static constexpr size_t maxCachedColumns = 256;
+    std::string columnCacheDir;
+    std::string columnCachePath;    // arquivo da chave atual ("": desligado)
+    std::uint64_t columnCacheKey = 0;
+    std::vector<std::vector<bool>> cachedColumns;   // pool inicial em isFeasible
+    std::set<std::vector<bool>> usefulColumns;      // suporte dos PLs de nó desta execução
+
+    // Componentes independentes (ver setDecompose)
+    static constexpr size_t maxProductAtoms = 4096;
+    bool decomposeEnabled = true;
+    const std::atomic<bool>* componentStop = nullptr;   // outro componente já é UNSAT
+    std::atomic<long>* componentNodes = nullptr;        // nós de todos os componentes
+
+    // Esforço da última chamada de solve
+    int totalNodes = 0;
+    int totalIterations = 0;
+    int totalColumns = 0;
+    FPStats stats;
+
+    // Cortes válidos para a relaxação do MILP
+    CutMode cutMode = CutMode::ROOT;
+    CutPool cutPool;
+    CutPool relationPool;       // relações da pré-resolução entre os átomos P
+
+    // Pré-processamento (refeito quando as fórmulas mudam)
+    bool preprocessed = false;
+    bool normalizeEnabled = true;
+    bool normalizedUnsat = false;   // alguma fórmula normalizou para ⊥
+    bool presolveEnabled = true;
+    bool presolveRelations = false;
+    static constexpr size_t maxPresolvePairAtoms = 128;    // acima disso, só átomo a átomo
+
+    // Simetrias da busca corrente (ver setSymmetry): pares de posições
+    // (p, q) com v[p] ≤ v[q] nas valorações geradas, e os geradores sobre
+    // as binárias na ordem dos nomes, com a posição de cada nome
+    bool symmetryEnabled = true;
+    std::vector<std::pair<int, int>> pricingOrder;
+    std::vector<BinaryGenerator> binaryGenerators;
+    std::map<std::string, size_t> binaryPosition;
+
+    // Fórmulas de entrada, no DAG compartilhado, e as mesmas normalizadas
+    FormulaStore store;
+    std::vector<FormulaId> inputFormulas;
+    std::vector<FormulaId> formulas;
+
+    // Estado incremental: tamanho de inputFormulas em cada push; prefixo já
+    // provado UNSAT (0: nenhum); colunas da última solução, com as
+    // valorações indexadas pelas variáveis do armazém; e o último ramo aberto
+    std::vector<size_t> scopes;
+    size_t unsatPrefix = 0;
+    std::vector<std::vector<bool>> seedValuations;
+    std::map<std::string, int> lastOpenBranch;
+
+    // Subfórmulas CPL alcançáveis pelos ψᵢ, em ordem crescente de ID,
+    // e a posição de cada uma nesse vetor (-1 fora dele)
+    std::vector<FormulaId> psiNodes;
+    std::vector<int> psiSlot;
+
+    // Posição na valoração de cada variável do armazém (-1 se não ocorre),
+    // e a variável do armazém em cada posição
+    std::vector<int> propVarToId;
+    std::vector<int> valuationVars;
 
     // Número total de variáveis proposicionais
     int numVars;
@@ -49,6 +242,8 @@ private:
     struct Branch {
         std::unique_ptr<LinearProgram> lp;
         std::map<std::string, int> fixedBinaries;
+        size_t depth = 0;           // binárias fixadas por explore
+        std::vector<std::vector<bool>> columns;  // colunas do PL do nó (só com checkpoint)
 
         Branch(std::unique_ptr<LinearProgram> lp_, std::map<std::string, int> fixed)
             : lp(std::move(lp_)), fixedBinaries(std::move(fixed)) {}
@@ -59,53 +254,128 @@ private:
         Branch& operator=(const Branch&) = delete;
     };
 
+    // Coluna p(·) do PL mestre
+    struct Column {
+        std::string name;
+        std::vector<bool> valuation;
+        std::vector<double> psiValues;  // ψᵢ(valuation)
+        int age = 0;                    // iterações seguidas fora da base
+    };
+
+    // Envelhecimento de colunas (0 desliga)
+    int columnAgeLimit = 10;
+    double columnAgeThreshold = 1e-3;
+
     // Informações da solução SAT
-    std::unordered_map<std::string, double> lastModalValues;
+    std::vector<std::pair<FormulaId, double>> lastModalValues;
     std::vector<double> lastProbDistribution;
     std::vector<std::vector<bool>> lastValuations;
+    FPResult lastResult;
 
     // Etapas principais
     void preprocess();
+    bool search();
+    std::vector<Branch> explore(std::vector<Branch> branches, std::set<std::string> binaries,
+                                const std::vector<FormulaId>& psiList, const std::vector<int>& xVars,
+                                const std::vector<int>& probConstraintRows, int sumProbRow);
+    void rememberSolution(const std::map<std::string, int>& openBranch);
+    std::uint64_t fingerprint(const std::set<std::string>& binaries) const;
+    void detectSymmetries(const std::vector<FormulaId>& psiList, const std::set<std::string>& binaries);
+    bool symmetricBranch(const std::map<std::string, int>& fixed) const;
+    void saveCheckpoint(const std::deque<Branch>& frontier);
+    void loadColumnCache();
+    std::vector<std::vector<FormulaId>> findComponents() const;
+    bool solveComponents(const std::vector<std::vector<FormulaId>>& components);
+    void saveColumnCache();
+    std::vector<Branch> resumeBranches(const LinearProgram& rootLP, const std::set<std::string>& binaries,
+                                       const std::vector<FormulaId>& psiList, const std::vector<int>& xVars,
+                                       const std::vector<int>& probConstraintRows, int sumProbRow);
+    void checkLimits();
+    void reportProgress(std::chrono::steady_clock::time_point now);
+
+    std::unique_ptr<LinearProgram> buildRootLP(std::vector<int>& xVars, std::vector<FormulaId>& psiList,
+                                               std::vector<int>& probConstraintRows, int& sumProbRow);
+    void encodeModalFormulas(LinearProgram& lp, std::vector<int>& xVars);
+    void encodeGadget(LinearProgram& lp, ModalConnective op, int leftX, int rightX, int xIdx, int bIdx);
+
+    void indexPsiNodes(const std::vector<FormulaId>& psiList);
+    std::vector<double> evaluatePsi(const std::vector<FormulaId>& psiList,
+                                    const std::vector<bool>& valuation) const;
+
+    Column addValuationColumn(const std::vector<FormulaId>& psiList,
+                              LinearProgram& lp,
+                              const std::vector<int>& probConstraintRows,
+                              int sumProbRow,
+                              const std::vector<bool>& valuation,
+                              const std::string& name);
+
+    void reinsertColumn(LinearProgram& lp,
+                        const std::vector<int>& probConstraintRows,
+                        int sumProbRow,
+                        const Column& col);
 
-    void encodeModalFormula(const ModalFormula& formula,
-                            LinearProgram& lp,
-                            std::unordered_map<std::string, int>& xVars,
-                            std::unordered_map<std::string, int>& bVars);
+    int ageColumns(LinearProgram& lp, std::vector<Column>& columns, std::vector<Column>& pool);
 
-    double evaluateCPL(const CPLFormula& formula,
-                       const std::unordered_map<std::string, bool>& valuation);
-    double evaluateCPL(const CPLFormula& formula,
-                       const std::vector<std::string>& varList,
-                       const std::vector<bool>& valuation);
+    // 'duals' da última solução do PL, lidos antes do envelhecimento
+    bool repriceColumnPool(LinearProgram& lp,
+                           const std::vector<double>& duals,
+                           const std::vector<int>& probConstraintRows,
+                           int sumProbRow,
+                           std::vector<Column>& columns,
+                           std::vector<Column>& pool);
 
-    bool isFeasible(const std::vector<std::unique_ptr<CPLFormula>>& psiList,
-                    const std::unordered_map<std::string, int>& propVarToId,
+    void dumpNode(const LinearProgram& lp, int node);
+
+    // Resolve o PL contabilizando tempo e tamanho em 'stats'
+    bool solveLP(LinearProgram& lp);
+
+    bool certifySolution(const std::vector<FormulaId>& psiList,
+                         const LinearProgram& leafLP,
+                         const std::vector<int>& probConstraintRows,
+                         int sumProbRow);
+
+    bool isFeasible(const std::vector<FormulaId>& psiList,
                     std::unique_ptr<LinearProgram> lp,
-                    const std::unordered_map<std::string, int>& xVars,
+                    const std::vector<int>& xVars,
                     const std::vector<int>& probConstraintRows,
-                    int sumProbRow);
+                    int sumProbRow,
+                    const std::vector<std::vector<bool>>& initialColumns = {});
 
-    bool addNewProbabilisticCoherenceConstraint(const std::vector<std::unique_ptr<CPLFormula>>& psiList,
-                                                const std::unordered_map<std::string, int>& propVarToId,
+    // 'duals' da última solução do PL (em modo exato, lidos do PL)
+    bool addNewProbabilisticCoherenceConstraint(const std::vector<FormulaId>& psiList,
                                                 LinearProgram& lp,
-                                                const std::unordered_map<std::string, int>& xVars,
+                                                const std::vector<double>& duals,
                                                 const std::vector<int>& probConstraintRows,
                                                 int sumProbRow,
                                                 std::set<std::vector<bool>>& usedValuations,
-                                                std::vector<std::vector<bool>>& lastValuationsLocal);
+                                                std::vector<Column>& columns,
+                                                bool exact);
 
     // Geração de colunas via PB-SAT
-    void writeOPBFile(const std::vector<std::unique_ptr<CPLFormula>>& psiList,
-                      const std::vector<double>& duals,
+    void writeOPBFile(const std::vector<FormulaId>& psiList,
+                      const std::vector<mpz_class>& coeffs,
                       const std::set<std::vector<bool>>& usedValuations,
                       const std::string& filename);
 
-    std::optional<std::vector<bool>> findValuationPB(const std::vector<std::unique_ptr<CPLFormula>>& psiList,
-                                                     const std::vector<double>& coeffs,
+    std::optional<std::vector<bool>> findValuationPB(const std::vector<FormulaId>& psiList,
+                                                     const std::vector<mpz_class>& coeffs,
                                                      const std::set<std::vector<bool>>& usedValuations);
 
-    // Salva solução em arquivo
-    void saveOutputToFile();
+    // Geração de colunas por padrões dos átomos P
+    std::optional<std::vector<bool>> findValuationPatterns(const std::vector<FormulaId>& psiList,
+                                                           const std::vector<double>& weights,
+                                                           const std::vector<mpq_class>& exactWeights,
+                                                           const std::set<std::vector<bool>>& usedValuations,
+                                                           bool exact);
+
+    // Rótulo p(·) pela própria valoração só na busca exaustiva (e se cabe
+    // num size_t); PB e padrões numeram as colunas em ordem de geração
+    bool valuationLabels() const {
+        return !usePB && !patternPricing && varList.size() <= 64;
+    }
+
+    // Registra o veredito (e a solução, se SAT) em lastResult
+    bool finish(FPStatus status, const std::string& reason);
 };
 
 #endif // SOLVER_HPP
@@ -0,0 +1,347 @@
+#include "symmetry.h"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+using C = CPLConnective;
+using M = ModalConnective;
+
+bool commutative(const FormulaNode& f) {
+    if (f.modal) {
+        M op = f.modalOp();
+        return op == M::AND || op == M::OR || op == M::IFF || op == M::OPLUS || op == M::ODOT;
+    }
+    C op = f.cplOp();
+    return op == C::AND || op == C::OR || op == C::IFF;
+}
+
+// Cadeias achatadas: só ∧ e ∨ clássicos
+bool chain(const FormulaNode& f) {
+    return !f.modal && (f.cplOp() == C::AND || f.cplOp() == C::OR);
+}
+
+// Troca dos operandos que complementa o b(·) do gadget
+bool flipsBinary(M op) {
+    return op == M::AND || op == M::OR || op == M::IFF;
+}
+
+// Classes das subfórmulas a menos da ordem dos operandos comutativos e da
+// associação das cadeias. As da fórmula original ficam numa tabela fixa;
+// cada troca de duas variáveis recalcula só os nós acima delas, numa tabela
+// descartada na troca seguinte, com números a partir dos da fixa: as classes
+// de uma troca só se comparam com as originais.
+class Canonizer {
+public:
+    Canonizer(const FormulaStore& store, const vector<FormulaId>& nodes, const vector<int>& slot)
+        : store(store), nodes(nodes), slot(slot), parents(nodes.size()), mark(nodes.size(), 0),
+          varSlot(store.numVars(), -1), needsClass(nodes.size(), true)
+    {
+        for (size_t k = 0; k < nodes.size(); ++k) {
+            const FormulaNode& f = store[nodes[k]];
+            if (!f.modal && f.cplOp() == C::VAR)
+                varSlot[f.var] = static_cast<int>(k);
+            for (FormulaId child : {f.left, f.right})
+                if (child != NO_FORMULA)
+                    parents[slot[child]].push_back(static_cast<int>(k));
+        }
+
+        // Nós internos de uma cadeia (todos os pais são a mesma cadeia) só
+        // entram achatados no topo dela e não têm classe própria
+        for (size_t k = 0; k < nodes.size(); ++k) {
+            const FormulaNode& f = store[nodes[k]];
+            needsClass[k] = !chain(f) || parents[k].empty() ||
+                            any_of(parents[k].begin(), parents[k].end(), [&](int p) {
+                                const FormulaNode& g = store[nodes[p]];
+                                return g.modal || g.op != f.op;
+                            });
+        }
+
+        baseClasses.assign(nodes.size(), -1);
+        for (size_t k = 0; k < nodes.size(); ++k)
+            if (needsClass[k])
+                baseClasses[k] = baseTable.emplace(key(k, baseClasses), static_cast<int>(baseTable.size())).first->second;
+        current = baseClasses;
+    }
+
+    const vector<int>& base() const { return baseClasses; }
+
+    // Classes com as variáveis a e b trocadas; valem até a próxima troca
+    const vector<int>& swapped(int a, int b) {
+        for (int k : cone)
+            current[k] = baseClasses[k];
+        cone.clear();
+        scratch.clear();
+        ++stamp;
+
+        // Nós acima das duas variáveis, em ordem topológica (a dos slots)
+        for (int v : {varSlot[a], varSlot[b]}) {
+            if (v < 0 || mark[v] == stamp)
+                continue;
+            mark[v] = stamp;
+            cone.push_back(v);
+        }
+        for (size_t i = 0; i < cone.size(); ++i)
+            for (int p : parents[cone[i]])
+                if (mark[p] != stamp) {
+                    mark[p] = stamp;
+                    cone.push_back(p);
+                }
+        sort(cone.begin(), cone.end());
+        effort += cone.size();
+
+        for (int k : cone) {
+            if (!needsClass[k])
+                continue;
+            const FormulaNode& f = store[nodes[k]];
+            auto entry = key(k, current);
+            if (!f.modal && f.cplOp() == C::VAR)
+                entry.second[0] = f.var == a ? b : a;
+            auto it = baseTable.find(entry);
+            current[k] = it != baseTable.end()
+                       ? it->second
+                       : scratch.emplace(move(entry), static_cast<int>(baseTable.size() + scratch.size())).first->second;
+        }
+        return current;
+    }
+
+    // Nós recalculados na última troca, em ordem; os demais mantêm a classe
+    const vector<int>& changed() const { return cone; }
+
+    // Tamanho das chaves e dos cones montados até aqui
+    size_t work() const { return effort; }
+
+private:
+    pair<int, vector<int>> key(size_t k, const vector<int>& cls) {
+        const FormulaNode& f = store[nodes[k]];
+        vector<int> operands;
+        if (!f.modal && f.cplOp() == C::VAR) {
+            operands.push_back(f.var);
+        } else if (chain(f)) {
+            // Cadeia achatada: desce pelos filhos com o mesmo conectivo
+            vector<FormulaId> stack{nodes[k]};
+            while (!stack.empty()) {
+                const FormulaNode& g = store[stack.back()];
+                stack.pop_back();
+                for (FormulaId child : {g.left, g.right}) {
+                    const FormulaNode& c = store[child];
+                    if (!c.modal && c.op == f.op)
+                        stack.push_back(child);
+                    else
+                        operands.push_back(cls[slot[child]]);
+                }
+            }
+            sort(operands.begin(), operands.end());
+        } else {
+            operands.push_back(cls[slot[f.left]]);
+            if (f.right != NO_FORMULA)
+                operands.push_back(cls[slot[f.right]]);
+            if (commutative(f))
+                sort(operands.begin(), operands.end());
+        }
+        effort += operands.size();
+        return {(f.modal ? 16 : 0) + f.op, move(operands)};
+    }
+
+    const FormulaStore& store;
+    const vector<FormulaId>& nodes;
+    const vector<int>& slot;
+    vector<vector<int>> parents;
+    vector<unsigned> mark;
+    unsigned stamp = 0;
+    vector<int> varSlot;
+    vector<bool> needsClass;
+    vector<int> baseClasses, current;
+    vector<int> cone;
+    map<pair<int, vector<int>>, int> baseTable, scratch;
+    size_t effort = 0;
+};
+
+// Entradas da assinatura: conectivo pai (16 CPL + 16 FP(Ł)) e lado (0 se
+// comutativo ou unário, 1 e 2 nos outros)
+constexpr int SIGNATURE_SIDES = 3;
+
+// Esforço máximo (tamanho das chaves e dos cones): ao esgotar, valem as
+// classes e geradores achados até ali
+constexpr size_t WORK_LIMIT = 20000000;
+
+} // namespace
+
+Symmetries findSymmetries(const FormulaStore& store, const vector<FormulaId>& formulas,
+                          const vector<FormulaId>& psis, const vector<int>& varPosition,
+                          const function<void()>& poll)
+{
+    Symmetries result;
+    vector<FormulaId> nodes = store.reachable(formulas);
+    vector<int> slot(store.size(), -1);
+    for (size_t k = 0; k < nodes.size(); ++k)
+        slot[nodes[k]] = static_cast<int>(k);
+
+    Canonizer canon(store, nodes, slot);
+    const vector<int>& base = canon.base();
+
+    auto rootClasses = [&](const vector<int>& cls) {
+        vector<int> roots;
+        for (FormulaId f : formulas)
+            roots.push_back(cls[slot[f]]);
+        sort(roots.begin(), roots.end());
+        return roots;
+    };
+    vector<int> baseRoots = rootClasses(base);
+
+    auto exhausted = [&]() {
+        poll();
+        if (canon.work() > WORK_LIMIT)
+            result.truncated = true;
+        return result.truncated;
+    };
+    auto formulaSymmetry = [&](int a, int b) {
+        return !exhausted() && rootClasses(canon.swapped(a, b)) == baseRoots;
+    };
+    auto pricingSymmetry = [&](int a, int b) {
+        if (exhausted())
+            return false;
+        const vector<int>& cls = canon.swapped(a, b);
+        return all_of(psis.begin(), psis.end(), [&](FormulaId psi) { return cls[slot[psi]] == base[slot[psi]]; });
+    };
+
+    // Ocorrências de cada variável nas fórmulas desdobradas em árvore
+    // (caminhos no DAG, mod 2^64), por conectivo pai e lado; uma troca só
+    // pode ser simetria entre variáveis de mesma assinatura. Assinaturas
+    // esparsas: pares (entrada, ocorrências) em ordem de entrada.
+    vector<uint64_t> paths(nodes.size(), 0);
+    for (FormulaId f : formulas)
+        ++paths[slot[f]];
+    vector<vector<pair<int, uint64_t>>> signature(store.numVars());
+    for (size_t k = nodes.size(); k-- > 0;) {
+        const FormulaNode& f = store[nodes[k]];
+        if (!f.modal && f.cplOp() == C::VAR)
+            continue;
+
+        bool ordered = f.right != NO_FORMULA && !commutative(f);
+        int side = 0;
+        for (FormulaId child : {f.left, f.right}) {
+            ++side;
+            if (child == NO_FORMULA)
+                continue;
+            paths[slot[child]] += paths[k];
+            const FormulaNode& c = store[child];
+            if (c.modal || c.cplOp() != C::VAR)
+                continue;
+            int entry = ((f.modal ? 16 : 0) + f.op) * SIGNATURE_SIDES + (ordered ? side : 0);
+            signature[c.var].emplace_back(entry, paths[k]);
+        }
+    }
+    for (auto& sig : signature) {
+        sort(sig.begin(), sig.end());
+        size_t n = 0;
+        for (const auto& e : sig) {
+            if (n > 0 && sig[n - 1].first == e.first)
+                sig[n - 1].second += e.second;
+            else
+                sig[n++] = e;
+        }
+        sig.resize(n);
+    }
+
+    // Variáveis da valoração em ordem de posição, agrupadas por assinatura
+    vector<int> vars;
+    for (int v = 0; v < store.numVars(); ++v)
+        if (varPosition[v] >= 0)
+            vars.push_back(v);
+    sort(vars.begin(), vars.end(), [&](int a, int b) { return varPosition[a] < varPosition[b]; });
+    map<vector<pair<int, uint64_t>>, vector<int>> groups;
+    for (int v : vars)
+        groups[signature[v]].push_back(v);
+
+    // Classes de equivalência: cada variável é testada contra um
+    // representante de cada classe já formada; esgotado o esforço, as
+    // restantes ficam fora
+    auto partition = [&](const vector<int>& members, auto&& symmetric) {
+        vector<vector<int>> classes;
+        for (int v : members) {
+            if (result.truncated)
+                break;
+            auto it = find_if(classes.begin(), classes.end(),
+                              [&](const vector<int>& cls) { return symmetric(cls.front(), v); });
+            if (it != classes.end())
+                it->push_back(v);
+            else
+                classes.push_back({v});
+        }
+        return classes;
+    };
+    auto positions = [&](const vector<int>& cls) {
+        vector<int> out;
+        for (int v : cls)
+            out.push_back(varPosition[v]);
+        return out;
+    };
+
+    vector<vector<int>> formulaVarClasses;
+    for (const auto& [sig, members] : groups) {
+        if (members.size() < 2)
+            continue;
+        for (auto& cls : partition(members, formulaSymmetry)) {
+            if (cls.size() < 2)
+                continue;
+            // Trocas que fixam cada ψᵢ fixam também as fórmulas
+            for (auto& sub : partition(cls, pricingSymmetry))
+                if (sub.size() > 1)
+                    result.pricingClasses.push_back(positions(sub));
+            result.formulaClasses.push_back(positions(cls));
+            formulaVarClasses.push_back(move(cls));
+        }
+    }
+
+    // A imagem de uma subfórmula modal é a de mesma classe, se única
+    map<int, FormulaId> modalByClass;
+    for (size_t k = 0; k < nodes.size(); ++k)
+        if (store[nodes[k]].modal && !modalByClass.emplace(base[k], nodes[k]).second)
+            return result;
+
+    for (const auto& cls : formulaVarClasses) {
+        for (size_t j = 0; j + 1 < cls.size() && !exhausted(); ++j) {
+            const vector<int>& image = canon.swapped(cls[j], cls[j + 1]);
+            vector<NodeImage> generator;
+            bool complete = true;
+            // Fora dos nós recalculados a imagem é o próprio nó
+            for (int k : canon.changed()) {
+                const FormulaNode& f = store[nodes[k]];
+                if (!f.modal || f.modalOp() == M::P_ATOM || f.modalOp() == M::NOT)
+                    continue;
+
+                auto it = modalByClass.find(image[k]);
+                if (it == modalByClass.end()) {
+                    complete = false;
+                    break;
+                }
+                const FormulaNode& g = store[it->second];
+                bool flip = flipsBinary(f.modalOp()) && image[slot[f.left]] != base[slot[g.left]];
+                if (it->second != nodes[k] || flip)
+                    generator.push_back(NodeImage{nodes[k], it->second, flip});
+            }
+            if (complete && !generator.empty())
+                result.generators.push_back(move(generator));
+        }
+    }
+    return result;
+}
+
+bool lexLeaderPossible(const BinaryGenerator& g, const vector<signed char>& values) {
+    for (const auto& e : g.entries) {
+        signed char own = values[e.position];
+        signed char image = values[e.source];
+        if (own < 0 || image < 0)
+            return true;
+        if (e.flip)
+            image = 1 - image;
+        if (own != image)
+            return own < image;
+    }
+    return true;
+}
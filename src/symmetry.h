@@ -0,0 +1,69 @@
+#ifndef SYMMETRY_HPP
+#define SYMMETRY_HPP
+
+#include "formula.h"
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Simetrias das fórmulas por trocas de duas variáveis proposicionais. As
+// fórmulas são comparadas a menos da ordem dos operandos dos conectivos
+// comutativos e, no nível CPL, da associação das cadeias de ∧ e ∨; no nível
+// FP(Ł) só a ordem, pois cada subfórmula modal tem suas colunas x(·) e b(·).
+// A relação "a troca (a b) é uma simetria" é de equivalência, e cada classe
+// de variáveis intercambiáveis gera o grupo simétrico sobre ela.
+
+// Imagem de uma subfórmula modal com b(·) por uma troca; 'flip' quando os
+// operandos de ∧, ∨ ou ↔ trocam de lugar, o que complementa o b(·) do
+// gadget (⊕ e ⊙ são simétricos nos operandos com o mesmo b)
+struct NodeImage {
+    FormulaId source;
+    FormulaId image;
+    bool flip;
+};
+
+struct Symmetries {
+    // Posições na valoração intercambiáveis em cada ψᵢ: a troca não muda
+    // nenhum ψᵢ, logo nenhuma coluna. Classes com 2+ posições, crescentes.
+    std::vector<std::vector<int>> pricingClasses;
+
+    // Posições intercambiáveis no conjunto de fórmulas (permutando os
+    // átomos P), e um gerador por par consecutivo de cada classe com as
+    // subfórmulas com b(·) movidas ou complementadas. Sem geradores se duas
+    // subfórmulas modais distintas coincidem a menos da ordem dos operandos.
+    std::vector<std::vector<int>> formulaClasses;
+    std::vector<std::vector<NodeImage>> generators;
+
+    // Busca interrompida pelo limite de esforço: as classes e os geradores
+    // acima são simetrias, mas podem faltar outros
+    bool truncated = false;
+};
+
+// 'psis' são os ψᵢ das colunas e 'varPosition' a posição na valoração de
+// cada variável do armazém (-1 se não ocorre). Só são testados os pares de
+// variáveis com as mesmas ocorrências por conectivo pai nas fórmulas. Cada
+// teste refaz só as subfórmulas acima das duas variáveis, e o esforço total
+// é limitado. 'poll' é chamada a cada teste e pode lançar para interromper.
+Symmetries findSymmetries(const FormulaStore& store, const std::vector<FormulaId>& formulas,
+                          const std::vector<FormulaId>& psis, const std::vector<int>& varPosition,
+                          const std::function<void()>& poll);
+
+// Gerador sobre as posições das binárias numa ordem fixa: a imagem de uma
+// atribuição b tem na posição 'position' o valor b[source], complementado
+// com 'flip'. As posições fixas e não complementadas ficam de fora.
+struct BinaryGenerator {
+    struct Entry {
+        size_t position;
+        size_t source;
+        bool flip;
+    };
+    std::vector<Entry> entries;     // em ordem crescente de posição
+};
+
+// Falso se toda completação da atribuição parcial 'values' (-1: livre) é
+// lexicograficamente maior que sua imagem por 'g'. Toda órbita tem um
+// menor elemento, que passa pelo teste com todos os geradores; os ramos
+// reprovados podem ser descartados.
+bool lexLeaderPossible(const BinaryGenerator& g, const std::vector<signed char>& values);
+
+#endif // SYMMETRY_HPP
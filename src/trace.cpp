@@ -0,0 +1,111 @@
+#include "trace.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct Event {
+    const char* name;
+    const char* argName;
+    std::int64_t arg;
+    std::int64_t begin;     // ns desde o início do rastreamento
+    std::int64_t duration;  // ns
+};
+
+// Buffer circular de uma thread; sobrevive à thread até a gravação
+struct ThreadBuffer {
+    int tid;
+    std::vector<Event> events;
+    std::size_t next = 0;       // total de eventos gravados
+};
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> registry;
+std::size_t bufferCapacity = 0;
+std::chrono::steady_clock::time_point origin;
+std::atomic<int> generation{0};   // muda a cada start: buffers antigos são trocados
+
+thread_local std::shared_ptr<ThreadBuffer> localBuffer;
+thread_local int localGeneration = -1;
+
+ThreadBuffer& threadBuffer() {
+    int current = generation.load(std::memory_order_acquire);
+    if (!localBuffer || localGeneration != current) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->tid = static_cast<int>(registry.size()) + 1;
+        buffer->events.resize(bufferCapacity);
+        registry.push_back(buffer);
+        localBuffer = std::move(buffer);
+        localGeneration = current;
+    }
+    return *localBuffer;
+}
+
+std::int64_t nanoseconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+} // namespace
+
+namespace trace {
+
+std::atomic<bool> enabled{false};
+
+void start(std::size_t capacity) {
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.clear();
+        bufferCapacity = capacity > 0 ? capacity : 1;
+        origin = std::chrono::steady_clock::now();
+    }
+    generation.fetch_add(1, std::memory_order_release);
+    enabled.store(true, std::memory_order_release);
+}
+
+void record(const char* name, std::chrono::steady_clock::time_point begin,
+            std::chrono::steady_clock::time_point end, const char* argName, std::int64_t arg) {
+    ThreadBuffer& buffer = threadBuffer();
+    buffer.events[buffer.next % buffer.events.size()] =
+        Event{name, argName, arg, nanoseconds(begin - origin), nanoseconds(end - begin)};
+    ++buffer.next;
+}
+
+void stop(const std::string& filename) {
+    enabled.store(false, std::memory_order_release);
+
+    std::ofstream out(filename);
+    if (!out)
+        throw std::runtime_error("Could not open file: " + filename);
+
+    // Eventos completos ("X") em microssegundos, thread a thread
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& buffer : registry) {
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffer->tid << ",\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+        first = false;
+
+        std::size_t size = buffer->events.size();
+        std::size_t count = std::min(buffer->next, size);
+        for (std::size_t k = buffer->next - count; k < buffer->next; ++k) {
+            const Event& e = buffer->events[k % size];
+            out << ",\n{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"ts\":" << e.begin / 1000.0 << ",\"dur\":" << e.duration / 1000.0;
+            if (e.argName)
+                out << ",\"args\":{\"" << e.argName << "\":" << e.arg << "}";
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    registry.clear();
+}
+
+} // namespace trace
@@ -0,0 +1,56 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Linha do tempo da resolução (--trace) no formato de eventos do Chrome
+// (chrome://tracing, Perfetto). Cada thread grava seus intervalos num buffer
+// circular próprio, sem trava; com o rastreamento desligado um TraceSpan só
+// lê uma flag. Se o buffer enche, os eventos mais antigos são descartados.
+
+namespace trace {
+
+extern std::atomic<bool> enabled;
+
+// Liga o rastreamento; 'capacity' eventos por thread
+void start(std::size_t capacity = std::size_t(1) << 16);
+
+// Desliga e grava os eventos de todas as threads em 'filename'. As threads
+// que gravam devem ter terminado (ou estar paradas).
+void stop(const std::string& filename);
+
+// Registra um intervalo já medido (tempos do steady_clock)
+void record(const char* name, std::chrono::steady_clock::time_point begin,
+            std::chrono::steady_clock::time_point end, const char* argName, std::int64_t arg);
+
+} // namespace trace
+
+// Intervalo do construtor ao destrutor; 'name' e 'argName' devem ser literais
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* argName = nullptr, std::int64_t arg = 0)
+        : name(name), argName(argName), arg(arg), active(trace::enabled.load(std::memory_order_relaxed)) {
+        if (active)
+            begin = std::chrono::steady_clock::now();
+    }
+
+    ~TraceSpan() {
+        if (active)
+            trace::record(name, begin, std::chrono::steady_clock::now(), argName, arg);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    const char* argName;
+    std::int64_t arg;
+    bool active;
+    std::chrono::steady_clock::time_point begin;
+};
+
+#endif // TRACE_HPP